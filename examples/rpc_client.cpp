@@ -5,12 +5,10 @@
 #include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
 #include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
 
-#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <string>
-#include <thread>
 
 namespace {
 long long parse_timeout(const char* value) {
@@ -84,8 +82,8 @@ int main(int argc, char** argv) {
         hakoniwa::pdu::rpc::ClientEventType event = hakoniwa::pdu::rpc::ClientEventType::NONE;
         std::string service_name;
         while (event == hakoniwa::pdu::rpc::ClientEventType::NONE) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            event = client.poll(service_name, res);
+            // Wakes on the response, or when the call's timeout is reached.
+            event = client.poll_wait(service_name, res, 0);
         }
 
         if (event == hakoniwa::pdu::rpc::ClientEventType::RESPONSE_IN) {
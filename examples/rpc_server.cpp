@@ -31,7 +31,7 @@ int main() {
 
     while (true) {
         hakoniwa::pdu::rpc::RpcRequest req;
-        auto event = server.poll(req);
+        auto event = server.poll_wait(req, 0);
         if (event == hakoniwa::pdu::rpc::ServerEventType::REQUEST_IN) {
             HakoCpp_AddTwoIntsRequest body;
             if (!helper.get_request_body(req, body)) {
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace hakoniwa::pdu::rpc {
+
+using PduData = std::vector<uint8_t>;
+
+/*
+ * Free list of receive buffers owned by one RPC endpoint.
+ *
+ * The recv callback acquires a buffer for each incoming packet and the packet
+ * is moved, not copied, through the pending queue into RpcRequest/RpcResponse.
+ * When that object is destroyed or refilled by the next poll(), the buffer is
+ * handed back here, so a steady request/response loop stops allocating.
+ */
+class PduBufferPool {
+public:
+    PduBufferPool(size_t buffer_size, size_t max_buffers)
+        : buffer_size_(buffer_size), max_buffers_(max_buffers)
+    {
+        // release() never grows the free list, so it cannot throw.
+        free_buffers_.reserve(max_buffers_);
+    }
+
+    PduData acquire(size_t size) {
+        PduData buffer;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!free_buffers_.empty()) {
+                buffer = std::move(free_buffers_.back());
+                free_buffers_.pop_back();
+            }
+        }
+        if (buffer.capacity() < buffer_size_) {
+            buffer.reserve(buffer_size_);
+        }
+        buffer.resize(size);
+        return buffer;
+    }
+
+    void release(PduData buffer) noexcept {
+        // Buffers too small for a full packet would only reallocate again.
+        if (buffer.capacity() < buffer_size_) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (free_buffers_.size() < max_buffers_) {
+            free_buffers_.push_back(std::move(buffer));
+        }
+    }
+
+    size_t buffer_size() const { return buffer_size_; }
+
+private:
+    std::mutex mtx_;
+    std::vector<PduData> free_buffers_;
+    size_t buffer_size_;
+    size_t max_buffers_;
+};
+
+} // namespace hakoniwa::pdu::rpc
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "rpc_services_client.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+namespace hakoniwa::pdu::rpc {
+
+/*
+ * Return type of a coroutine that awaits RPC calls:
+ *
+ *   RpcTask add(RpcCallScheduler& scheduler, PduData request) {
+ *       RpcCallResult result = co_await scheduler.async_call("Service/Add", std::move(request), 1000000);
+ *       ...
+ *   }
+ *   scheduler.spawn(add(scheduler, std::move(request)));
+ *
+ * The coroutine does not run until it is handed to RpcCallScheduler::spawn(),
+ * which then owns it.
+ */
+class RpcTask {
+public:
+    struct promise_type {
+        RpcTask get_return_object() { return RpcTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+    };
+
+    RpcTask(RpcTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    RpcTask(const RpcTask&) = delete;
+    RpcTask& operator=(const RpcTask&) = delete;
+    RpcTask& operator=(RpcTask&&) = delete;
+    ~RpcTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+private:
+    friend class RpcCallScheduler;
+    explicit RpcTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/*
+ * Single-threaded scheduler that owns the poll loop of an RpcServicesClient
+ * and resumes the coroutines awaiting its calls.
+ *
+ * A suspended call costs a map entry rather than a thread, so one thread can
+ * keep any number of logical calls open. Calls beyond a service's
+ * "maxInFlight" window wait in the scheduler and are sent, in order, as
+ * earlier calls of that service complete.
+ *
+ * When a call times out, its coroutine resumes with RESPONSE_TIMEOUT and the
+ * scheduler sends the cancel request; the call keeps its window slot until
+ * the server answers that cancel. If the cancel cannot be sent, the client
+ * drops the call and its slot goes to the next waiting call at once.
+ *
+ * All members, and the coroutines themselves, run on the thread that calls
+ * run() or run_once(). While the scheduler is in use the application must not
+ * call() or poll() the client itself.
+ */
+class RpcCallScheduler {
+public:
+    class CallAwaiter {
+    public:
+        bool await_ready() const noexcept { return false; }
+        // false resumes the coroutine at once, with RpcCallResult::event NONE.
+        bool await_suspend(std::coroutine_handle<> handle) { return scheduler_->start_call(*this, handle); }
+        RpcCallResult await_resume() { return std::move(result_); }
+
+    private:
+        friend class RpcCallScheduler;
+        CallAwaiter(RpcCallScheduler* scheduler, const std::string& service_name, PduData&& request_pdu, uint64_t timeout_usec)
+            : scheduler_(scheduler), service_name_(service_name), request_pdu_(std::move(request_pdu)), timeout_usec_(timeout_usec) {}
+
+        RpcCallScheduler* scheduler_;
+        std::string service_name_;
+        PduData request_pdu_;
+        uint64_t timeout_usec_;
+        std::coroutine_handle<> handle_;
+        RpcCallResult result_;
+    };
+
+    explicit RpcCallScheduler(RpcServicesClient& client);
+    // Destroys the coroutines that have not finished.
+    ~RpcCallScheduler();
+
+    RpcCallScheduler(const RpcCallScheduler&) = delete;
+    RpcCallScheduler& operator=(const RpcCallScheduler&) = delete;
+
+    /*
+     * Awaitable call. request_pdu is a request buffer of the service, e.g.
+     * from RpcServicesClient::create_request_buffer(); timeout_usec is as for
+     * RpcServicesClient::call().
+     */
+    CallAwaiter async_call(const std::string& service_name, PduData request_pdu, uint64_t timeout_usec) {
+        return CallAwaiter(this, service_name, std::move(request_pdu), timeout_usec);
+    }
+
+    // Takes ownership of the coroutine; it first runs in the next run_once().
+    void spawn(RpcTask task);
+
+    /*
+     * Handles the client events that are available and resumes the coroutines
+     * they complete. When none is, blocks in poll_wait() for up to
+     * timeout_usec (0 waits without limit).
+     *
+     * @return The number of coroutines resumed.
+     */
+    size_t run_once(uint64_t timeout_usec);
+    // Runs until every spawned coroutine has finished. Returns false if the
+    // remaining ones wait for something other than a call of this scheduler.
+    bool run();
+
+    size_t task_count() const { return tasks_.size(); }
+
+private:
+    using CallKey = std::pair<std::string, Hako_uint32>;
+
+    bool start_call(CallAwaiter& awaiter, std::coroutine_handle<> handle);
+    bool issue(CallAwaiter& awaiter);
+    void handle_event(ClientEventType event, const std::string& service_name, RpcResponse& response);
+    void release_slot(const std::string& service_name);
+    void resume(std::coroutine_handle<> handle);
+
+    RpcServicesClient& client_;
+    // Frame addresses of the spawned coroutines that have not finished.
+    std::unordered_set<void*> tasks_;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::map<CallKey, CallAwaiter*> waiting_;
+    // Timed out and cancelled; the slot is freed when the cancel is answered.
+    std::set<CallKey> abandoned_;
+    std::map<std::string, size_t> in_flight_;
+    std::map<std::string, std::deque<CallAwaiter*>> parked_;
+};
+
+} // namespace hakoniwa::pdu::rpc
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "rpc_types.hpp"
+#include "rpc_event_notifier.hpp"
+#include "rpc_timer_wheel.hpp"
+#include <memory>
 #include <string>
 #include <nlohmann/json_fwd.hpp>
 
@@ -13,20 +16,68 @@ public:
 
     virtual bool initialize(const nlohmann::json& service_config, int pdu_meta_data_size) = 0;
     virtual bool call(const PduData& pdu, uint64_t timeout_usec) = 0;
+    // Same as call(), and reports the request_id the request was issued with.
+    virtual bool call(const PduData& pdu, uint64_t timeout_usec, Hako_uint32& request_id) = 0;
     virtual ClientEventType poll(RpcResponse& response) = 0;
     virtual bool send_cancel_request() = 0;
+    virtual bool send_cancel_request(Hako_uint32 request_id) = 0;
     virtual void create_request_buffer(Hako_uint8 opcode, bool is_cancel_request, PduData& pdu) = 0;
+    /*
+     * Writes the request packet into a caller-owned buffer instead of a PduData.
+     * out_size is set to the packet size; false is returned without issuing a
+     * request_id when the buffer is missing or smaller than that.
+     */
+    virtual bool create_request_buffer(Hako_uint8 opcode, bool is_cancel_request, uint8_t* buffer, size_t capacity, size_t& out_size) = 0;
     virtual void clear_pending_responses() = 0;
+    virtual bool has_in_flight() = 0;
+    // Number of calls that may be outstanding at once ("maxInFlight").
+    virtual size_t get_max_in_flight() const = 0;
+    // Called when the timer of a call fires; the next poll() reports it once
+    // as RESPONSE_TIMEOUT.
+    virtual void expire_call(Hako_uint32 request_id) = 0;
 
     const std::string& get_service_name() const { return service_name_; }
     const std::string& get_client_name() const { return client_name_; }
+    // Notified whenever a response arrives, and by poll() while more events
+    // are left. Set before initialize().
+    void set_event_notifier(std::shared_ptr<RpcEventNotifier> notifier, size_t slot) {
+        event_notifier_ = std::move(notifier);
+        event_slot_ = slot;
+    }
+    size_t get_event_slot() const { return event_slot_; }
+    // Call timeouts are scheduled on this wheel under the event slot, and
+    // come back through expire_call(). Set before initialize().
+    void set_timer_wheel(std::shared_ptr<RpcTimerWheel> timer_wheel) {
+        timer_wheel_ = std::move(timer_wheel);
+    }
 protected:
     IRpcClientEndpoint(const std::string& service_name, const std::string& client_name, uint64_t delta_time_usec)
         : service_name_(service_name), client_name_(client_name), delta_time_usec_(delta_time_usec) {}
 
+    void notify_event() {
+        if (event_notifier_) {
+            event_notifier_->notify(event_slot_);
+        }
+    }
+    // Keep the notifier's count of outstanding calls in step with the calls
+    // this endpoint tracks.
+    void calls_started(size_t count) {
+        if (event_notifier_) {
+            event_notifier_->add_in_flight(count);
+        }
+    }
+    void calls_finished(size_t count) {
+        if (event_notifier_) {
+            event_notifier_->remove_in_flight(count);
+        }
+    }
+
     std::string service_name_;
     std::string client_name_;
     uint64_t delta_time_usec_;
+    std::shared_ptr<RpcEventNotifier> event_notifier_;
+    size_t event_slot_ = 0;
+    std::shared_ptr<RpcTimerWheel> timer_wheel_;
 };
 
 }
@@ -1,13 +1,18 @@
 #pragma once
 
 #include "rpc_client_endpoint.hpp"
+#include "rpc_endpoint_registry.hpp"
+#include "rpc_packet.hpp"
 #include "hakoniwa/time_source/time_source.hpp"
 #include "hakoniwa/pdu/endpoint.hpp"
 #include <string>
 #include <memory>
+#include <deque>
 #include <vector>
 #include <map>
 #include <mutex>
+#include <span>
+#include <unordered_map>
 #include <nlohmann/json_fwd.hpp>
 
 namespace hakoniwa::pdu::rpc {
@@ -22,10 +27,20 @@ enum ClientState {
 struct ClientProcessingStatus {
     Hako_uint32 request_id;
     ClientState state;
+    uint64_t start_time_usec;
+    uint64_t timeout_usec;
+    RpcTimerWheel::TimerId timer = 0;
+    // Set when the timer fired. The call stays RUNNING so that a late
+    // response is held back until the caller cancels it.
+    bool timed_out = false;
 };
 
 class RpcClientEndpointImpl : public IRpcClientEndpoint, public std::enable_shared_from_this<RpcClientEndpointImpl> {
 public:
+    // Default number of requests that may be in flight at once. Overridden per
+    // service by the optional "maxInFlight" entry of the service config.
+    static constexpr size_t DEFAULT_MAX_IN_FLIGHT = 1;
+
     RpcClientEndpointImpl(
         const std::string& service_name,
         const std::string& client_name,
@@ -37,77 +52,93 @@ public:
 
     bool initialize(const nlohmann::json& service_config, int pdu_meta_data_size) override;
     bool call(const PduData& pdu, uint64_t timeout_usec) override;
+    bool call(const PduData& pdu, uint64_t timeout_usec, Hako_uint32& request_id) override;
     ClientEventType poll(RpcResponse& response) override;
 
+    /*
+     * A cancel request buffer targets the most recently issued request that is
+     * still in flight; use send_cancel_request(request_id) to pick another one.
+     */
     void create_request_buffer(Hako_uint8 opcode, bool is_cancel_request, PduData& pdu) override {
-        PduKey pdu_key = {service_name_, client_name_ + "Req"};
-        auto request_pdu_size = endpoint_->get_pdu_size(pdu_key);
-        pdu.resize(request_pdu_size);
-        HakoCpp_ServiceRequestHeader request_header;
-        auto request_id = is_cancel_request ? client_state_.request_id : ++current_request_id_;
-        request_header.request_id = request_id;
-        request_header.client_name = client_name_;
-        request_header.service_name = service_name_;
-        request_header.opcode = opcode;
-        request_header.status_poll_interval_msec = 0;
-        (void)convertor_request_.cpp2pdu(request_header, reinterpret_cast<char*>(pdu.data()), request_pdu_size);
+        std::lock_guard<std::recursive_mutex> lock(mtx_);
+        build_request_buffer(opcode, next_request_id(is_cancel_request), pdu);
     }
-    bool send_cancel_request()  override {
-        PduData pdu;
+    bool create_request_buffer(Hako_uint8 opcode, bool is_cancel_request, uint8_t* buffer, size_t capacity, size_t& out_size) override;
+    bool send_cancel_request() override {
         std::lock_guard<std::recursive_mutex> lock(mtx_);
-        if (client_state_.state != CLIENT_STATE_RUNNING) {
+        if (in_flight_.empty()) {
             std::cerr << "ERROR: Cannot send cancel request, client is not in RUNNING state." << std::endl;
             return false;
         }
-        create_request_buffer(HAKO_SERVICE_OPERATION_CODE_CANCEL, true, pdu);
-        try {
-            if (send_request(pdu)) {
-                client_state_.state = CLIENT_STATE_CANCELLING;
-                return true;
-            } else {
-                std::cerr << "ERROR: send_request failed for cancel request." << std::endl;
-                return false;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "ERROR: Failed to send cancel request: " << e.what() << std::endl;
-            return false;
-        }
+        return send_cancel_request(in_flight_.back().request_id);
     }
+    bool send_cancel_request(Hako_uint32 request_id) override;
+    // The registry holds weak references, so endpoints are released with
+    // their last owner whether or not this is called.
     void clear_all_instances();
+    static size_t instance_count();
     void clear_pending_responses() override;
+    bool has_in_flight() override;
+    size_t get_max_in_flight() const override { return max_in_flight_; }
+    void expire_call(Hako_uint32 request_id) override;
 
 
 protected:
-    void put_pending_response(const hakoniwa::pdu::PduKey& pdu_key, const PduData& pdu_data) {
-        std::lock_guard<std::recursive_mutex> lock(mtx_);
-        pending_responses_.emplace_back(PendingResponse{pdu_key, pdu_data});
-    }
+    void put_pending_response(PduData&& pdu_data);
+    PduData acquire_response_buffer(std::span<const std::byte> data);
+    void release_response_buffer(PduData&& pdu_data);
     bool send_request(const PduData& pdu);
+    bool build_request_template();
+    void build_request_buffer(Hako_uint8 opcode, Hako_uint32 request_id, PduData& pdu);
+    void patch_request_header(uint8_t* packet, Hako_uint8 opcode, Hako_uint32 request_id) const;
+    Hako_uint32 next_request_id(bool is_cancel_request);
 private:
     std::shared_ptr<hakoniwa::pdu::Endpoint> endpoint_;
     std::shared_ptr<hakoniwa::time_source::ITimeSource> time_source_;
     std::recursive_mutex mtx_;
+    // Resolved once in initialize(); send_request() sends by channel.
+    hakoniwa::pdu::PduResolvedKey request_key_;
+    size_t request_pdu_size_ = 0;
+    // REQUEST packet for this (service, client) serialized once in
+    // initialize(). New requests copy it and patch request_id and opcode at
+    // request_header_off_, the offset of Hako_ServiceRequestHeader.
+    PduData request_template_;
+    size_t request_header_off_ = 0;
 
-    // A queue to hold incoming requests detected by the callback
-    struct PendingResponse {
-        hakoniwa::pdu::PduKey pdu_key;
-        PduData pdu_data;
-    };
-    ClientProcessingStatus client_state_;
-    std::vector<PendingResponse> pending_responses_;
+    // Requests sent and not yet completed, in issue order. Each has its own
+    // timer, so a window of up to max_in_flight_ calls can be pipelined.
+    std::vector<ClientProcessingStatus> in_flight_;
+    size_t max_in_flight_ = DEFAULT_MAX_IN_FLIGHT;
+    // Responses received by the callback, filed under the request_id read
+    // from their header in place. Only responses for in-flight requests are
+    // retained; the header is converted when poll() hands one out.
+    std::unordered_map<Hako_uint32, PduData> pending_responses_;
+    // Request ids of pending_responses_ in arrival order, so poll() takes the
+    // next one without scanning the window. An id whose response was already
+    // taken, or is held back by a timeout, is skipped when popped.
+    std::deque<Hako_uint32> ready_;
+    // Calls whose timer fired, to be reported by poll() in firing order.
+    std::deque<Hako_uint32> expired_;
+    static constexpr size_t RESPONSE_BUFFER_POOL_SIZE = 4;
+    std::shared_ptr<PduBufferPool> response_buffer_pool_;
     hako::pdu::PduConvertor<HakoCpp_ServiceRequestHeader, hako::pdu::msgs::hako_srv_msgs::ServiceRequestHeader> convertor_request_;
-    hako::pdu::PduConvertor<HakoCpp_ServiceResponseHeader, hako::pdu::msgs::hako_srv_msgs::ServiceResponseHeader> convertor_response_;
     
     static void pdu_recv_callback(const hakoniwa::pdu::PduResolvedKey& pdu_key, std::span<const std::byte> data);
-    static std::vector<std::shared_ptr<RpcClientEndpointImpl>> instances_;
+    static RpcEndpointRegistry<RpcClientEndpointImpl> instances_;
 
-    uint64_t current_timeout_usec_;
-    uint64_t request_start_time_usec_;
     uint64_t current_request_id_ = 0;
 
-    bool validate_header(HakoCpp_ServiceResponseHeader& header);
-    ClientEventType handle_response_in(RpcResponse& request);
-    ClientEventType handle_cancel_response(RpcResponse& request);
+    ClientProcessingStatus* find_in_flight(Hako_uint32 request_id);
+    void remove_in_flight(Hako_uint32 request_id);
+    static bool is_held_back(const ClientProcessingStatus& status) {
+        return status.timed_out && status.state == CLIENT_STATE_RUNNING;
+    }
+    void expire_elapsed_calls();
+    bool has_events() const;
+    ClientEventType poll_next(RpcResponse& response);
+    bool validate_header(const RpcResponseHeaderView& header);
+    ClientEventType handle_response_in(RpcResponse& response, const RpcResponseHeaderView& header);
+    ClientEventType handle_cancel_response(RpcResponse& response);
 };
 
 } // namespace hakoniwa::pdu::rpc
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hakoniwa::pdu::rpc {
+
+/*
+ * Process-wide index of live RPC endpoints, keyed by service name.
+ *
+ * Entries hold weak references, so registering never extends an endpoint's
+ * lifetime: an endpoint removes its own entry from its destructor, and one
+ * that is released without that (e.g. a failed initialize) is pruned on the
+ * next lookup. Lookup and removal hash the service name; the endpoints
+ * sharing one name (one per connection behind RpcServicesMuxServer) are
+ * kept in a small vector that is swap-and-popped.
+ */
+template <typename T>
+class RpcEndpointRegistry {
+public:
+    void add(const std::string& service_name, const std::shared_ptr<T>& endpoint) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto& entries = entries_[service_name];
+        for (const auto& entry : entries) {
+            if (entry.endpoint == endpoint.get()) {
+                return;
+            }
+        }
+        entries.push_back(Entry{endpoint.get(), endpoint});
+    }
+
+    void remove(const std::string& service_name, const T* endpoint) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = entries_.find(service_name);
+        if (it == entries_.end()) {
+            return;
+        }
+        auto& entries = it->second;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].endpoint == endpoint) {
+                entries[i] = std::move(entries.back());
+                entries.pop_back();
+                break;
+            }
+        }
+        if (entries.empty()) {
+            entries_.erase(it);
+        }
+    }
+
+    // Live endpoints registered under service_name, in no particular order.
+    std::vector<std::shared_ptr<T>> find(const std::string& service_name) {
+        std::vector<std::shared_ptr<T>> live;
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = entries_.find(service_name);
+        if (it == entries_.end()) {
+            return live;
+        }
+        auto& entries = it->second;
+        for (size_t i = 0; i < entries.size();) {
+            if (auto endpoint = entries[i].ref.lock()) {
+                live.push_back(std::move(endpoint));
+                ++i;
+            } else {
+                entries[i] = std::move(entries.back());
+                entries.pop_back();
+            }
+        }
+        if (entries.empty()) {
+            entries_.erase(it);
+        }
+        return live;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        size_t count = 0;
+        for (const auto& [service_name, entries] : entries_) {
+            count += entries.size();
+        }
+        return count;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        entries_.clear();
+    }
+
+private:
+    struct Entry {
+        // Identity for remove(), which runs when ref can no longer be locked.
+        const T* endpoint;
+        std::weak_ptr<T> ref;
+    };
+    mutable std::mutex mtx_;
+    std::unordered_map<std::string, std::vector<Entry>> entries_;
+};
+
+} // namespace hakoniwa::pdu::rpc
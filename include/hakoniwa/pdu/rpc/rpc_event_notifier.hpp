@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace hakoniwa::pdu::rpc {
+
+/*
+ * Ready list and wakeup for the endpoints of one RpcServicesServer or
+ * RpcServicesClient.
+ *
+ * Each endpoint is given a slot. Its recv callback calls notify(slot) when it
+ * queues a request or response, and its poll() calls it again while work is
+ * left, so poll() of the services object only visits the slots returned by
+ * pop_ready() instead of locking every endpoint. A slot is listed at most once,
+ * which bounds the list by the number of endpoints.
+ *
+ * notify() also wakes a thread blocked in poll_wait(). A waiter reads
+ * sequence() before it polls and passes that value to wait_for(), so an event
+ * queued between the poll and the wait is not lost.
+ */
+class RpcEventNotifier {
+public:
+    void notify(size_t slot) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (slot >= listed_.size()) {
+                grow(slot + 1);
+            }
+            if (!listed_[slot]) {
+                listed_[slot] = true;
+                ready_[(ready_head_ + ready_count_) % ready_.size()] = slot;
+                ++ready_count_;
+            }
+            ++sequence_;
+        }
+        cv_.notify_all();
+    }
+
+    // Takes the oldest ready slot. A slot that is notified again after this
+    // returns is listed again.
+    bool pop_ready(size_t& slot) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (ready_count_ == 0) {
+            return false;
+        }
+        slot = ready_[ready_head_];
+        ready_head_ = (ready_head_ + 1) % ready_.size();
+        --ready_count_;
+        listed_[slot] = false;
+        return true;
+    }
+
+    void clear_ready() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        listed_.assign(listed_.size(), false);
+        ready_head_ = 0;
+        ready_count_ = 0;
+    }
+
+    uint64_t sequence() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return sequence_;
+    }
+
+    // Returns true when notify() was called after `seen` was read, false
+    // when the timeout expired first.
+    bool wait_for(uint64_t seen, std::chrono::microseconds timeout) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return cv_.wait_for(lock, timeout, [this, seen] { return sequence_ != seen; });
+    }
+
+    void wait(uint64_t seen) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this, seen] { return sequence_ != seen; });
+    }
+
+    // Calls outstanding on the endpoints of an RpcServicesClient, kept by the
+    // endpoints, so a waiter can tell whether any event can still come
+    // without locking each endpoint.
+    void add_in_flight(size_t count) { in_flight_.fetch_add(count); }
+    void remove_in_flight(size_t count) { in_flight_.fetch_sub(count); }
+    size_t in_flight() const { return in_flight_.load(); }
+
+private:
+    // Slots are handed out while the services are initialized, so this
+    // normally runs before any traffic; listed slots keep their order.
+    void grow(size_t slots) {
+        std::vector<size_t> ready(slots);
+        for (size_t i = 0; i < ready_count_; ++i) {
+            ready[i] = ready_[(ready_head_ + i) % ready_.size()];
+        }
+        ready_ = std::move(ready);
+        ready_head_ = 0;
+        listed_.resize(slots, false);
+    }
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    uint64_t sequence_ = 0;
+    // Ring of listed slots; listed_[slot] is true while slot is in it.
+    std::vector<size_t> ready_;
+    size_t ready_head_ = 0;
+    size_t ready_count_ = 0;
+    std::vector<bool> listed_;
+    std::atomic<size_t> in_flight_{0};
+};
+
+} // namespace hakoniwa::pdu::rpc
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "hako_srv_msgs/pdu_ctype_ServiceRequestHeader.h"
+#include "hako_srv_msgs/pdu_ctype_ServiceResponseHeader.h"
+#include "hako_srv_msgs/pdu_cpptype_ServiceRequestHeader.hpp"
+#include "hako_srv_msgs/pdu_cpptype_ServiceResponseHeader.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+namespace hakoniwa::pdu::rpc {
+
+/*
+ * Layout helpers for serialized RPC packets.
+ *
+ * A packet starts with HakoPduMetaDataType, followed by the base area holding
+ * the service header and body, then the heap. metadata.total_size covers only
+ * the heap actually used, so it is usually far below the configured PDU size.
+ */
+
+// Locates the base area and checks that a header of header_size bytes fits
+// inside both the used packet (total_size) and the buffer.
+inline bool rpc_packet_base_offset(const uint8_t* data, size_t size, size_t header_size, size_t& base_off_out)
+{
+    HakoPduMetaDataType metadata{};
+    if (data == nullptr || size < sizeof(metadata)) {
+        return false;
+    }
+    std::memcpy(&metadata, data, sizeof(metadata));
+    if (HAKO_PDU_METADATA_IS_INVALID(&metadata) || metadata.base_off < 0 || metadata.total_size < 0) {
+        return false;
+    }
+    const auto base_off = static_cast<size_t>(metadata.base_off);
+    const auto total_size = static_cast<size_t>(metadata.total_size);
+    if (total_size > size || base_off > total_size || header_size > total_size - base_off) {
+        return false;
+    }
+    base_off_out = base_off;
+    return true;
+}
+
+// Bytes of the packet that must go on the wire. Buffers without valid
+// metadata are sent whole, as before.
+inline size_t rpc_packet_wire_size(const uint8_t* data, size_t size)
+{
+    size_t base_off = 0;
+    if (!rpc_packet_base_offset(data, size, 0, base_off)) {
+        return size;
+    }
+    HakoPduMetaDataType metadata{};
+    std::memcpy(&metadata, data, sizeof(metadata));
+    return static_cast<size_t>(metadata.total_size);
+}
+
+/*
+ * Read-only views of the service header inside a packet.
+ *
+ * Fields are read from their fixed offsets and names come back as
+ * string_views into the packet, so routing and validating a packet allocates
+ * nothing. copy_to() performs the full conversion when a header is handed to
+ * the application; assigning into an existing object reuses its string
+ * capacity. A view is valid only while the packet it was bound to is.
+ */
+template <typename CHeader>
+class RpcHeaderView {
+public:
+    // False when the packet is too short or its metadata is invalid.
+    bool bind(const uint8_t* data, size_t size) {
+        size_t base_off = 0;
+        if (!rpc_packet_base_offset(data, size, sizeof(CHeader), base_off)) {
+            header_ = nullptr;
+            return false;
+        }
+        header_ = data + base_off;
+        return true;
+    }
+    bool valid() const { return header_ != nullptr; }
+    Hako_uint32 request_id() const { return read<Hako_uint32>(offsetof(CHeader, request_id)); }
+    std::string_view service_name() const { return read_name(offsetof(CHeader, service_name)); }
+    std::string_view client_name() const { return read_name(offsetof(CHeader, client_name)); }
+
+protected:
+    template <typename T>
+    T read(size_t offset) const {
+        T value;
+        std::memcpy(&value, header_ + offset, sizeof(value));
+        return value;
+    }
+    std::string_view read_name(size_t offset) const {
+        const auto* name = reinterpret_cast<const char*>(header_ + offset);
+        const auto* end = static_cast<const char*>(std::memchr(name, '\0', HAKO_STRING_SIZE));
+        return std::string_view(name, end != nullptr ? static_cast<size_t>(end - name) : HAKO_STRING_SIZE);
+    }
+
+    const uint8_t* header_ = nullptr;
+};
+
+class RpcRequestHeaderView : public RpcHeaderView<Hako_ServiceRequestHeader> {
+public:
+    Hako_uint8 opcode() const {
+        return read<Hako_uint8>(offsetof(Hako_ServiceRequestHeader, opcode));
+    }
+    auto status_poll_interval_msec() const {
+        return read<decltype(Hako_ServiceRequestHeader::status_poll_interval_msec)>(
+            offsetof(Hako_ServiceRequestHeader, status_poll_interval_msec));
+    }
+    void copy_to(HakoCpp_ServiceRequestHeader& header) const {
+        header.request_id = request_id();
+        header.service_name.assign(service_name());
+        header.client_name.assign(client_name());
+        header.opcode = opcode();
+        header.status_poll_interval_msec = status_poll_interval_msec();
+    }
+};
+
+class RpcResponseHeaderView : public RpcHeaderView<Hako_ServiceResponseHeader> {
+public:
+    Hako_uint8 status() const {
+        return read<Hako_uint8>(offsetof(Hako_ServiceResponseHeader, status));
+    }
+    Hako_uint8 processing_percentage() const {
+        return read<Hako_uint8>(offsetof(Hako_ServiceResponseHeader, processing_percentage));
+    }
+    Hako_int32 result_code() const {
+        return read<Hako_int32>(offsetof(Hako_ServiceResponseHeader, result_code));
+    }
+    void copy_to(HakoCpp_ServiceResponseHeader& header) const {
+        header.request_id = request_id();
+        header.service_name.assign(service_name());
+        header.client_name.assign(client_name());
+        header.status = status();
+        header.processing_percentage = processing_percentage();
+        header.result_code = result_code();
+    }
+};
+
+/*
+ * Read-only view of a whole typed packet, e.g. Hako_AddTwoIntsRequestPacket.
+ *
+ * header() and body() are the generated C structs inside the packet, so
+ * fixed-size fields, fixed arrays and strings are read without conversion.
+ * Variable-length arrays live in the heap; the C struct holds their element
+ * count and heap offset (_<field>_len, _<field>_off), which heap_array()
+ * turns into a span after checking that it lies inside the packet:
+ *
+ *   std::span<const Hako_float32> data;
+ *   if (view.heap_array(view.body()._data_len, view.body()._data_off, data)) ...
+ *
+ * Like the header views, a view is valid only while its packet is.
+ */
+template <typename CPacket>
+class RpcPacketView {
+public:
+    using CHeader = decltype(CPacket::header);
+    using CBody = decltype(CPacket::body);
+
+    // False when the packet is too short, misaligned or its metadata is invalid.
+    bool bind(const uint8_t* data, size_t size) {
+        packet_ = nullptr;
+        heap_ = nullptr;
+        heap_size_ = 0;
+        size_t base_off = 0;
+        if (!rpc_packet_base_offset(data, size, sizeof(CHeader), base_off)) {
+            return false;
+        }
+        // Writers may leave the struct's trailing padding out of the packet,
+        // but the buffer itself has to hold the whole struct.
+        if (sizeof(CPacket) > size - base_off
+            || reinterpret_cast<uintptr_t>(data + base_off) % alignof(CPacket) != 0) {
+            return false;
+        }
+        HakoPduMetaDataType metadata{};
+        std::memcpy(&metadata, data, sizeof(metadata));
+        if (metadata.heap_off < metadata.base_off || metadata.heap_off > metadata.total_size) {
+            return false;
+        }
+        packet_ = reinterpret_cast<const CPacket*>(data + base_off);
+        heap_ = data + metadata.heap_off;
+        heap_size_ = static_cast<size_t>(metadata.total_size - metadata.heap_off);
+        return true;
+    }
+    bool valid() const { return packet_ != nullptr; }
+    const CHeader& header() const { return packet_->header; }
+    const CBody& body() const { return packet_->body; }
+
+    // False when the array does not fit in the heap or is misaligned for T.
+    template <typename T>
+    bool heap_array(Hako_int32 length, Hako_int32 offset, std::span<const T>& array_out) const {
+        array_out = {};
+        if (packet_ == nullptr || length < 0 || offset < 0) {
+            return false;
+        }
+        const auto count = static_cast<size_t>(length);
+        const auto off = static_cast<size_t>(offset);
+        if (off > heap_size_ || count > (heap_size_ - off) / sizeof(T)) {
+            return false;
+        }
+        const uint8_t* first = heap_ + off;
+        if (reinterpret_cast<uintptr_t>(first) % alignof(T) != 0) {
+            return false;
+        }
+        array_out = std::span<const T>(reinterpret_cast<const T*>(first), count);
+        return true;
+    }
+
+private:
+    const CPacket* packet_ = nullptr;
+    const uint8_t* heap_ = nullptr;
+    size_t heap_size_ = 0;
+};
+
+} // namespace hakoniwa::pdu::rpc
@@ -1,8 +1,11 @@
 #pragma once
 #include "rpc_types.hpp"
+#include "rpc_event_notifier.hpp"
+#include <memory>
 #include <string>
 #include <nlohmann/json_fwd.hpp>
 #include <optional>
+#include <span>
 
 namespace hakoniwa::pdu::rpc {
 
@@ -13,17 +16,40 @@ public:
     virtual bool initialize(const nlohmann::json& service_config, int pdu_meta_data_size, std::optional<std::string> client_node_id = std::nullopt) = 0;
 
     virtual ServerEventType poll(RpcRequest& request) = 0;
+    /*
+     * Fills up to requests.size() entries under one lock and returns how many
+     * were filled. Each one is what poll() would have returned; a cancel is
+     * told apart by HAKO_SERVICE_OPERATION_CODE_CANCEL in header.opcode.
+     */
+    virtual size_t poll_batch(std::span<RpcRequest> requests) = 0;
 
     virtual void send_reply(std::string client_name, const PduData& pdu) = 0;
     virtual void send_cancel_reply(std::string client_name, const PduData& pdu) = 0;
+    // Reply to one specific request when a client has several in flight.
+    virtual void send_reply(std::string client_name, Hako_uint32 request_id, const PduData& pdu) = 0;
+    virtual void send_cancel_reply(std::string client_name, Hako_uint32 request_id, const PduData& pdu) = 0;
     virtual void create_reply_buffer(const HakoCpp_ServiceRequestHeader& header, Hako_uint8 status, Hako_int32 result_code, PduData& pdu) = 0;
     virtual void clear_pending_requests() = 0;
     const std::string& get_service_name() const { return service_name_; }
+    // Notified whenever a request becomes ready to poll, and by poll() while
+    // more are queued. Set before initialize().
+    void set_event_notifier(std::shared_ptr<RpcEventNotifier> notifier, size_t slot) {
+        event_notifier_ = std::move(notifier);
+        event_slot_ = slot;
+    }
+    size_t get_event_slot() const { return event_slot_; }
 protected:
     IRpcServerEndpoint(const std::string& service_name, uint64_t delta_time_usec)
         : service_name_(service_name), delta_time_usec_(delta_time_usec) {}
+    void notify_event() {
+        if (event_notifier_) {
+            event_notifier_->notify(event_slot_);
+        }
+    }
     std::string service_name_;
     uint64_t delta_time_usec_;
+    std::shared_ptr<RpcEventNotifier> event_notifier_;
+    size_t event_slot_ = 0;
 };
 
 }
@@ -1,13 +1,21 @@
 #pragma once
 
 #include "rpc_server_endpoint.hpp"
+#include "rpc_endpoint_registry.hpp"
+#include "rpc_packet.hpp"
 #include "hakoniwa/time_source/time_source.hpp"
 #include "hakoniwa/pdu/endpoint.hpp"
 #include <string>
+#include <cstddef>
+#include <deque>
 #include <memory>
 #include <vector>
 #include <map>
 #include <mutex>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <cstring>
 #include <nlohmann/json_fwd.hpp>
 
 namespace hakoniwa::pdu::rpc {
@@ -26,6 +34,16 @@ struct ServerProcessingStatus {
 
 class RpcServerEndpointImpl : public IRpcServerEndpoint, public std::enable_shared_from_this<RpcServerEndpointImpl> {
 public:
+    // Default bound of the received-request queue. Overridden per service by
+    // the optional "requestQueueCapacity" entry of the service config.
+    static constexpr size_t DEFAULT_REQUEST_QUEUE_CAPACITY = 1024;
+    // Default number of requests one client may have in flight. Overridden
+    // per service by the optional "maxInFlight" entry of the service config.
+    static constexpr size_t DEFAULT_MAX_IN_FLIGHT = 1;
+    // Requests a client may have waiting behind a full in-flight window.
+    // 0 (the default) answers BUSY at once; set per service by "queueDepth".
+    static constexpr size_t DEFAULT_QUEUE_DEPTH = 0;
+
     RpcServerEndpointImpl(
         const std::string& service_name,
         uint64_t delta_time_usec,
@@ -37,37 +55,46 @@ public:
     bool initialize(const nlohmann::json& service_config, int pdu_meta_data_size, std::optional<std::string> client_node_id = std::nullopt) override;
 
     ServerEventType poll(RpcRequest& request) override;
-    void create_reply_buffer(const HakoCpp_ServiceRequestHeader& header, Hako_uint8 status, Hako_int32 result_code, PduData& pdu) override {
-        PduKey pdu_key = {header.service_name, header.client_name + "Res"};
-        auto response_pdu_size = endpoint_->get_pdu_size(pdu_key);
-        pdu.resize(response_pdu_size);
-        HakoCpp_ServiceResponseHeader response_header;
-        response_header.request_id = header.request_id;
-        response_header.client_name = header.client_name;
-        response_header.service_name = header.service_name;
-        response_header.status = status;
-        response_header.processing_percentage = 100;
-        response_header.result_code = result_code;
-        convertor_response_.cpp2pdu(response_header, reinterpret_cast<char*>(pdu.data()), response_pdu_size);
-    }
-    void send_error_reply(const HakoCpp_ServiceRequestHeader& header, Hako_int32 result_code) {
-        PduData pdu;
-        create_reply_buffer(header, HAKO_SERVICE_STATUS_ERROR, result_code, pdu);
-        send_reply(header.client_name, pdu);
-    }
+    size_t poll_batch(std::span<RpcRequest> requests) override;
+    void create_reply_buffer(const HakoCpp_ServiceRequestHeader& header, Hako_uint8 status, Hako_int32 result_code, PduData& pdu) override;
+    // Rejects a request that was never admitted, so no in-flight state changes.
+    void send_error_reply(const HakoCpp_ServiceRequestHeader& header, Hako_int32 result_code);
 
     void send_reply(std::string client_name, const PduData& pdu) override;
+    void send_reply(std::string client_name, Hako_uint32 request_id, const PduData& pdu) override;
 
     void send_cancel_reply(std::string client_name, const PduData& pdu) override;
+    void send_cancel_reply(std::string client_name, Hako_uint32 request_id, const PduData& pdu) override;
     void clear_pending_requests() override;
+    // The registry holds weak references, so endpoints are released with
+    // their last owner whether or not this is called.
     static void clear_all_instances() {
         instances_.clear();
     }
+    static size_t instance_count() {
+        return instances_.size();
+    }
 
 protected:
-    void put_pending_request(const hakoniwa::pdu::PduKey& pdu_key, const PduData& pdu_data) {
+    void put_pending_request(const hakoniwa::pdu::PduKey& pdu_key, PduData&& pdu_data) {
         std::lock_guard<std::recursive_mutex> lock(mtx_);
-        pending_requests_.emplace_back(PendingRequest{pdu_key, pdu_data});
+        if (pending_requests_.size() >= request_queue_capacity_) {
+            std::cerr << "ERROR: Request queue is full for service: " << service_name_
+                      << " (capacity=" << request_queue_capacity_ << "), request dropped" << std::endl;
+            if (request_buffer_pool_) {
+                request_buffer_pool_->release(std::move(pdu_data));
+            }
+            return;
+        }
+        pending_requests_.emplace_back(PendingRequest{pdu_key, std::move(pdu_data)});
+        notify_event();
+    }
+    PduData acquire_request_buffer(std::span<const std::byte> data) {
+        PduData pdu_data = request_buffer_pool_ ? request_buffer_pool_->acquire(data.size()) : PduData(data.size());
+        if (!data.empty()) {
+            std::memcpy(pdu_data.data(), data.data(), data.size());
+        }
+        return pdu_data;
     }
 private:
     std::shared_ptr<hakoniwa::pdu::Endpoint> endpoint_;
@@ -79,26 +106,78 @@ private:
         hakoniwa::pdu::PduKey pdu_key;
         PduData pdu_data;
     };
-    std::map<std::string, ServerProcessingStatus> server_states_;
-    std::vector<std::string> registered_clients_;
-    std::vector<PendingRequest> pending_requests_;
+    // Client names are interned to dense ids when they are registered. The id
+    // indexes client_states_, so a request costs one name lookup and the
+    // state transitions after it are plain array accesses.
+    static constexpr size_t INVALID_CLIENT_ID = static_cast<size_t>(-1);
+    // The response route and size are resolved at registration so replies
+    // are sent by channel without rebuilding "<client>Res" per call.
+    // in_flight holds at most max_in_flight_ requests, in arrival order.
+    // queued holds up to queue_depth_ requests that arrived while it was full.
+    struct ClientEntry {
+        std::string client_name;
+        std::vector<ServerProcessingStatus> in_flight;
+        std::deque<RpcRequest> queued;
+        hakoniwa::pdu::PduResolvedKey response_key;
+        size_t response_pdu_size;
+        // Response packet with this client's names serialized once at
+        // registration. Replies copy it and patch the per-reply fields of the
+        // Hako_ServiceResponseHeader found at reply_header_off.
+        PduData reply_template;
+        size_t reply_header_off;
+        // Scratch packet for the header-only replies the endpoint sends by
+        // itself (errors, cancelled queued requests), always under mtx_.
+        PduData header_reply;
+    };
+    // Transparent, so a name viewed in a received packet is looked up
+    // without building a std::string.
+    struct ClientNameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+    std::unordered_map<std::string, size_t, ClientNameHash, std::equal_to<>> client_ids_;
+    std::vector<ClientEntry> client_states_;
+    // FIFO of received request packets. Both ends are O(1), so a deep backlog
+    // does not make each poll() more expensive while mtx_ is held.
+    std::deque<PendingRequest> pending_requests_;
+    size_t request_queue_capacity_ = DEFAULT_REQUEST_QUEUE_CAPACITY;
+    // Receive buffers sized for one request PDU. Shared with the RpcRequest
+    // objects handed out by poll() so their buffers can come back.
+    std::shared_ptr<PduBufferPool> request_buffer_pool_;
     size_t max_clients_;
+    size_t max_in_flight_ = DEFAULT_MAX_IN_FLIGHT;
+    size_t queue_depth_ = DEFAULT_QUEUE_DEPTH;
+    // Queued requests admitted when a reply freed their client's slot. poll()
+    // hands these out before decoding newly received packets.
+    std::deque<RpcRequest> released_requests_;
     bool dynamic_client_ = false;
     HakoPduChannelIdType dynamic_request_channel_id_ = 0;
     HakoPduChannelIdType dynamic_response_channel_id_ = 0;
     size_t dynamic_request_pdu_size_ = 0;
     size_t dynamic_response_pdu_size_ = 0;
-    hako::pdu::PduConvertor<HakoCpp_ServiceRequestHeader, hako::pdu::msgs::hako_srv_msgs::ServiceRequestHeader> convertor_request_;
     hako::pdu::PduConvertor<HakoCpp_ServiceResponseHeader, hako::pdu::msgs::hako_srv_msgs::ServiceResponseHeader> convertor_response_;
     
     static void pdu_recv_callback(const hakoniwa::pdu::PduResolvedKey& pdu_key, std::span<const std::byte> data);
-    static std::vector<std::shared_ptr<RpcServerEndpointImpl>> instances_;
+    static RpcEndpointRegistry<RpcServerEndpointImpl> instances_;
 
 
-    bool validate_header(HakoCpp_ServiceRequestHeader& header);
-    bool ensure_dynamic_client(const std::string& client_name);
-    ServerEventType handle_request_in(RpcRequest& request);
-    ServerEventType handle_cancel_request(RpcRequest& request);
+    ServerEventType poll_next(RpcRequest& request);
+    bool has_queued_requests() const { return !released_requests_.empty() || !pending_requests_.empty(); }
+    size_t register_client(const std::string& client_name, HakoPduChannelIdType response_channel_id, size_t response_pdu_size);
+    bool serialize_reply_header(const HakoCpp_ServiceResponseHeader& response_header, size_t response_pdu_size, PduData& pdu);
+    bool build_reply_template(ClientEntry& client);
+    static void patch_reply_header(const ClientEntry& client, uint8_t* packet, Hako_uint32 request_id, Hako_uint8 status, Hako_int32 result_code);
+    void send_header_reply(ClientEntry& client, Hako_uint32 request_id, Hako_uint8 status, Hako_int32 result_code);
+    void send_response_pdu(const ClientEntry& client, const PduData& pdu);
+    bool resolve_reply_request_id(const ClientEntry& client, const PduData& pdu, Hako_uint32& request_id);
+    static ServerProcessingStatus* find_in_flight(ClientEntry& client, Hako_uint32 request_id);
+    void complete_in_flight(ClientEntry& client, ServerProcessingStatus* status);
+    size_t find_client_id(std::string_view client_name) const;
+    bool validate_header(const RpcRequestHeaderView& header, size_t& client_id);
+    size_t ensure_dynamic_client(std::string_view client_name);
+    static void accept_request(RpcRequest& request, const RpcRequestHeaderView& header);
+    ServerEventType handle_request_in(RpcRequest& request, const RpcRequestHeaderView& header, ClientEntry& client);
+    ServerEventType handle_cancel_request(RpcRequest& request, const RpcRequestHeaderView& header, ClientEntry& client);
 };
 
 } // namespace hakoniwa::pdu::rpc
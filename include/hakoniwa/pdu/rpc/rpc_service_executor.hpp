@@ -0,0 +1,112 @@
+#pragma once
+
+#include "rpc_services_server.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace hakoniwa::pdu::rpc {
+
+/*
+ * Runs request handlers of an RpcServicesServer on a pool of worker threads.
+ *
+ * One dispatcher thread polls the server and hands each request to the
+ * handler registered for its service. Requests of the same client to the same
+ * service form a strand: they run one at a time and in arrival order, which
+ * is the order the server's per-client window admits them in. Different
+ * strands run concurrently, so a slow handler only delays its own client.
+ *
+ * Handlers reply through the server they are given. send_reply(),
+ * send_cancel_reply() and create_reply_buffer() lock the service endpoint, so
+ * they may be called from any worker. A request of a service without a
+ * handler, or whose handler throws, is answered with an ERROR reply.
+ *
+ * Cancels bypass the strands. A cancel of a request that has not started yet
+ * drops it from its strand. A cancel of a running request sets the flag that
+ * cancel_requested() reports, so a long handler can poll it and stop early;
+ * the handler then must not reply, since the cancel is answered for it. A
+ * cancel without a cancel handler is answered as CANCELED by the dispatcher
+ * at once; a cancel handler runs on the next free worker, ahead of queued
+ * requests and concurrently with the handler of the request it cancels.
+ *
+ * Handlers are registered before start(). While the executor runs, the
+ * application must not poll the server itself.
+ */
+class RpcServiceExecutor {
+public:
+    using Handler = std::function<void(RpcServicesServer& server, RpcRequest& request)>;
+
+    RpcServiceExecutor(RpcServicesServer& server, size_t worker_count);
+    ~RpcServiceExecutor();
+
+    RpcServiceExecutor(const RpcServiceExecutor&) = delete;
+    RpcServiceExecutor& operator=(const RpcServiceExecutor&) = delete;
+
+    bool register_handler(const std::string& service_name, Handler handler);
+    bool register_cancel_handler(const std::string& service_name, Handler handler);
+
+    // True once a cancel arrived for request while its handler runs. Safe to
+    // call from the handler.
+    bool cancel_requested(const RpcRequest& request);
+
+    bool start();
+    // Stops polling, runs the requests already dispatched, and joins all threads.
+    void stop();
+    bool is_running() const { return running_; }
+    size_t worker_count() const { return worker_count_; }
+
+private:
+    struct Task {
+        ServerEventType event = ServerEventType::NONE;
+        RpcRequest request;
+    };
+    struct Strand {
+        std::deque<Task> tasks;
+        // True while the strand is runnable or one of its tasks is running.
+        bool scheduled = false;
+        bool running = false;
+        Hako_uint32 running_request_id = 0;
+        bool cancel_requested = false;
+    };
+
+    // How long the dispatcher blocks in poll_wait() before it rechecks running_.
+    static constexpr uint64_t DISPATCH_WAIT_USEC = 10000;
+    static constexpr size_t DISPATCH_BATCH_SIZE = 32;
+
+    void dispatch_loop();
+    void dispatch(ServerEventType event, RpcRequest&& request);
+    void dispatch_cancel(RpcRequest&& request);
+    void worker_loop();
+    void run(Task& task);
+    void reply_error(RpcRequest& request);
+    static std::string strand_key(const RpcRequest& request);
+
+    RpcServicesServer& server_;
+    size_t worker_count_;
+    std::unordered_map<std::string, Handler> handlers_;
+    std::unordered_map<std::string, Handler> cancel_handlers_;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    // Keyed by service name and client name. Elements of an unordered_map
+    // keep their address, so runnable_ can point at them.
+    std::unordered_map<std::string, Strand> strands_;
+    std::deque<Strand*> runnable_;
+    // Cancels for a cancel handler; workers take these before any strand.
+    std::deque<Task> cancels_;
+    bool stopping_ = false;
+
+    std::atomic<bool> running_{false};
+    std::thread dispatcher_;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace hakoniwa::pdu::rpc
@@ -3,18 +3,47 @@
 #include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
 #include "hakoniwa/pdu/rpc/rpc_services_mux_server.hpp"
 #include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_packet.hpp"
 
+#include <cstring>
 #include <iostream>
+#include <optional>
+#include <type_traits>
 
 /** Shorthand macro to resolve PDU type */
 #define HAKO_RPC_SERVICE_SERVER_TYPE(type) hako::pdu::msgs::hako_srv_msgs::type
 
 namespace hakoniwa::pdu::rpc {
+/*
+ * Typed request/response bodies for one service type.
+ *
+ * When the C packet types and the generated body encoders
+ * (cpp_cpp2pdu_<Type>Request/Response) are given, as
+ * HakoRpcServiceServerTemplateType does, set_request_body() and
+ * set_response_body() serialize only the body into the buffer whose header
+ * create_request_buffer()/create_reply_buffer() already wrote. Without them
+ * the whole packet is decoded and encoded again.
+ *
+ * The C packet types also enable get_request_view() and get_response_view(),
+ * zero-copy alternatives to get_request_body() and get_response_body() for
+ * bodies whose arrays make the conversion expensive.
+ *
+ * call() and reply() build each packet in a buffer the object keeps, so a
+ * long-lived instance allocates nothing per call in steady state. An
+ * instance is not meant to be shared between threads.
+ */
 template<typename CppReqPacketType, typename CppResPacketType,
          typename CppReqBodyType, typename CppResBodyType,
-         typename ConvertorReq, typename ConvertorRes>
+         typename ConvertorReq, typename ConvertorRes,
+         typename CReqPacketType = void, typename CResPacketType = void,
+         auto EncodeReqBody = nullptr, auto EncodeResBody = nullptr>
 class HakoRpcAssetServiceServer {
 public:
+    using RequestBody = CppReqBodyType;
+    using ResponseBody = CppResBodyType;
+    using RequestView = RpcPacketView<CReqPacketType>;
+    using ResponseView = RpcPacketView<CResPacketType>;
+
     HakoRpcAssetServiceServer() = default;
     virtual ~HakoRpcAssetServiceServer() = default;
 
@@ -42,6 +71,24 @@ public:
         return true;
     }
 
+    // The view refers to request.pdu, which must outlive it.
+    bool get_request_view(const RpcRequest& request, RequestView& view) requires (!std::is_void_v<CReqPacketType>) {
+        if (!view.bind(request.pdu.data(), request.pdu.size())) {
+            std::cerr << "ERROR: Failed to bind request PDU view." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // The view refers to response.pdu, which must outlive it.
+    bool get_response_view(const RpcResponse& response, ResponseView& view) requires (!std::is_void_v<CResPacketType>) {
+        if (!view.bind(response.pdu.data(), response.pdu.size())) {
+            std::cerr << "ERROR: Failed to bind response PDU view." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
     bool set_response_body(
         RpcServicesServer& server,
         RpcRequest& request,
@@ -54,6 +101,19 @@ public:
         return encode_response_body(res_body, response_pdu);
     }
 
+    bool set_response_body(
+        RpcServicesServer& server,
+        ServiceHandle service,
+        RpcRequest& request,
+        Hako_uint8 status,
+        Hako_int32 result_code,
+        const CppResBodyType& res_body,
+        PduData& response_pdu)
+    {
+        server.create_reply_buffer(service, request.header, status, result_code, response_pdu);
+        return encode_response_body(res_body, response_pdu);
+    }
+
     bool set_response_body(
         RpcServicesMuxServer& server,
         RpcMuxRequest& request,
@@ -72,36 +132,36 @@ public:
     bool set_request_body(
         RpcServicesClient& client,
         const std::string& service_name,
-        CppReqBodyType& req_body,
+        const CppReqBodyType& req_body,
         PduData& request_pdu)
     {
-        client.create_request_buffer(service_name, request_pdu);
-        ConvertorReq convertor_request;
-        CppReqPacketType request_packet;
-        auto ret = convertor_request.pdu2cpp(reinterpret_cast<char*>(request_pdu.data()), request_packet);
-        if (!ret) {
-            std::cerr << "ERROR: Failed to convert request PDU to C++ type." << std::endl;
+        if (!client.create_request_buffer(service_name, request_pdu)) {
+            std::cerr << "ERROR: Failed to create request PDU." << std::endl;
             return false;
         }
-        request_packet.body = req_body;
-        int size = convertor_request.cpp2pdu(
-            request_packet,
-            reinterpret_cast<char*>(request_pdu.data()),
-            request_pdu.size());
-        if (size < 0) {
-            std::cerr << "ERROR: Failed to convert request C++ type to PDU." << std::endl;
+        return encode_request_body(req_body, request_pdu);
+    }
+
+    bool set_request_body(
+        RpcServicesClient& client,
+        ServiceHandle service,
+        const CppReqBodyType& req_body,
+        PduData& request_pdu)
+    {
+        if (!client.create_request_buffer(service, request_pdu)) {
+            std::cerr << "ERROR: Failed to create request PDU." << std::endl;
             return false;
         }
-        return true;
+        return encode_request_body(req_body, request_pdu);
     }
 
     bool call(
         RpcServicesClient& client,
         const std::string& service_name,
-        CppReqBodyType& req_body,
+        const CppReqBodyType& req_body,
         uint64_t timeout_usec)
     {
-        PduData request_pdu;
+        PduData& request_pdu = scratch_pdu();
         bool set_req_body = set_request_body(client, service_name, req_body, request_pdu);
         if (!set_req_body) {
             std::cerr << "ERROR: Failed to set request body." << std::endl;
@@ -110,6 +170,21 @@ public:
         return client.call(service_name, request_pdu, timeout_usec);
     }
 
+    bool call(
+        RpcServicesClient& client,
+        ServiceHandle service,
+        const CppReqBodyType& req_body,
+        uint64_t timeout_usec)
+    {
+        PduData& request_pdu = scratch_pdu();
+        bool set_req_body = set_request_body(client, service, req_body, request_pdu);
+        if (!set_req_body) {
+            std::cerr << "ERROR: Failed to set request body." << std::endl;
+            return false;
+        }
+        return client.call(service, request_pdu, timeout_usec);
+    }
+
     bool reply(
         RpcServicesServer& server,
         RpcRequest& request,
@@ -117,7 +192,7 @@ public:
         Hako_int32 result_code,
         const CppResBodyType& res_body)
     {
-        PduData response_pdu;
+        PduData& response_pdu = scratch_pdu();
         bool set_res_body = set_response_body(
             server, request, status, result_code, res_body, response_pdu);
         if (!set_res_body) {
@@ -128,6 +203,25 @@ public:
         return true;
     }
 
+    bool reply(
+        RpcServicesServer& server,
+        ServiceHandle service,
+        RpcRequest& request,
+        Hako_uint8 status,
+        Hako_int32 result_code,
+        const CppResBodyType& res_body)
+    {
+        PduData& response_pdu = scratch_pdu();
+        bool set_res_body = set_response_body(
+            server, service, request, status, result_code, res_body, response_pdu);
+        if (!set_res_body) {
+            std::cerr << "ERROR: Failed to set response body." << std::endl;
+            return false;
+        }
+        server.send_reply(service, request.header, response_pdu);
+        return true;
+    }
+
     bool reply(
         RpcServicesMuxServer& server,
         RpcMuxRequest& request,
@@ -135,7 +229,7 @@ public:
         Hako_int32 result_code,
         const CppResBodyType& res_body)
     {
-        PduData response_pdu;
+        PduData& response_pdu = scratch_pdu();
         bool set_res_body = set_response_body(
             server, request, status, result_code, res_body, response_pdu);
         if (!set_res_body) {
@@ -146,10 +240,62 @@ public:
     }
 
 private:
+    // call() and reply() build each packet here and send it at once, so the
+    // buffer keeps its capacity between calls.
+    PduData scratch_pdu_;
+    // Heap of the body being encoded. PduDynamicMemory has no reset of its
+    // own, so each encode rebuilds it in place.
+    std::optional<PduDynamicMemory> dynamic_memory_;
+
+    PduData& scratch_pdu() { return scratch_pdu_; }
+
+    PduDynamicMemory& reset_dynamic_memory()
+    {
+        dynamic_memory_.emplace();
+        return *dynamic_memory_;
+    }
+
+    bool encode_request_body(
+        const CppReqBodyType& req_body,
+        PduData& request_pdu)
+    {
+        if constexpr (!std::is_void_v<CReqPacketType>) {
+            if (!encode_body_in_place<CReqPacketType, EncodeReqBody>(req_body, request_pdu)) {
+                std::cerr << "ERROR: Failed to convert request C++ type to PDU." << std::endl;
+                return false;
+            }
+            return true;
+        }
+        ConvertorReq convertor_request;
+        CppReqPacketType request_packet;
+        auto ret = convertor_request.pdu2cpp(reinterpret_cast<char*>(request_pdu.data()), request_packet);
+        if (!ret) {
+            std::cerr << "ERROR: Failed to convert request PDU to C++ type." << std::endl;
+            return false;
+        }
+        request_packet.body = req_body;
+        int size = convertor_request.cpp2pdu(
+            request_packet,
+            reinterpret_cast<char*>(request_pdu.data()),
+            request_pdu.size());
+        if (size < 0) {
+            std::cerr << "ERROR: Failed to convert request C++ type to PDU." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
     bool encode_response_body(
         const CppResBodyType& res_body,
         PduData& response_pdu)
     {
+        if constexpr (!std::is_void_v<CResPacketType>) {
+            if (!encode_body_in_place<CResPacketType, EncodeResBody>(res_body, response_pdu)) {
+                std::cerr << "ERROR: Failed to convert response C++ type to PDU." << std::endl;
+                return false;
+            }
+            return true;
+        }
         ConvertorRes convertor_response;
         CppResPacketType response_packet;
         auto ret = convertor_response.pdu2cpp(
@@ -169,6 +315,43 @@ private:
         }
         return true;
     }
+
+    /*
+     * Encodes body into the body member of the packet, whose header is
+     * already in place, then points the metadata at the body's heap. The
+     * header bytes are neither decoded nor written.
+     */
+    template <typename CPacketType, auto EncodeBody, typename CppBodyType>
+    bool encode_body_in_place(const CppBodyType& body, PduData& pdu)
+    {
+        size_t base_off = 0;
+        if (!rpc_packet_base_offset(pdu.data(), pdu.size(), sizeof(CPacketType::header), base_off)) {
+            return false;
+        }
+        constexpr size_t alignment = HAKO_ALIGNMENT_SIZE;
+        const size_t heap_off = base_off + ((sizeof(CPacketType) + alignment - 1) & ~(alignment - 1));
+        if (heap_off > pdu.size()) {
+            return false;
+        }
+        auto* packet = reinterpret_cast<CPacketType*>(pdu.data() + base_off);
+        PduDynamicMemory& dynamic_memory = reset_dynamic_memory();
+        if (!EncodeBody(body, packet->body, dynamic_memory)) {
+            return false;
+        }
+        const size_t heap_size = dynamic_memory.get_total_size();
+        if (heap_size > pdu.size() - heap_off) {
+            std::cerr << "ERROR: Body needs " << heap_size << " bytes of heap, but the PDU has "
+                      << (pdu.size() - heap_off) << std::endl;
+            return false;
+        }
+        dynamic_memory.copy_to_pdu(reinterpret_cast<char*>(pdu.data() + heap_off));
+        HakoPduMetaDataType metadata{};
+        std::memcpy(&metadata, pdu.data(), sizeof(metadata));
+        metadata.heap_off = static_cast<decltype(metadata.heap_off)>(heap_off);
+        metadata.total_size = static_cast<decltype(metadata.total_size)>(heap_off + heap_size);
+        std::memcpy(pdu.data(), &metadata, sizeof(metadata));
+        return true;
+    }
 };
 
 } // namespace hakoniwa::pdu::rpc
@@ -181,4 +364,8 @@ private:
         HakoCpp_##SRVNAME##Request, \
         HakoCpp_##SRVNAME##Response, \
         HAKO_RPC_SERVICE_SERVER_TYPE(SRVNAME##RequestPacket), \
-        HAKO_RPC_SERVICE_SERVER_TYPE(SRVNAME##ResponsePacket)>
+        HAKO_RPC_SERVICE_SERVER_TYPE(SRVNAME##ResponsePacket), \
+        Hako_##SRVNAME##RequestPacket, \
+        Hako_##SRVNAME##ResponsePacket, \
+        &cpp_cpp2pdu_##SRVNAME##Request, \
+        &cpp_cpp2pdu_##SRVNAME##Response>
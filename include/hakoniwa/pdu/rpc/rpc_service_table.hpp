@@ -0,0 +1,301 @@
+#pragma once
+
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hakoniwa::pdu::rpc {
+
+struct RpcClientInfo {
+    const char* name;
+    int32_t request_channel_id;
+    int32_t response_channel_id;
+};
+
+/*
+ * One service of a generated service table. The sizes are the pduSize
+ * entries of the service config: "server" is the request base size and the
+ * response heap size, "client" the response base size and the request heap
+ * size.
+ */
+struct RpcServiceInfo {
+    const char* name;
+    const char* type;
+    uint32_t max_clients;
+    size_t server_base_size;
+    size_t server_heap_size;
+    size_t client_base_size;
+    size_t client_heap_size;
+    std::span<const RpcClientInfo> clients;
+};
+
+/*
+ * Index of the service called name in table, or N when there is none.
+ * Usable in constant expressions, so a misspelled service name fails to
+ * compile:
+ *
+ *   static_assert(rpc_service_index(MyTable::services, "Service/Add") == MyTable::ADD);
+ */
+template <size_t N>
+constexpr size_t rpc_service_index(const RpcServiceInfo (&table)[N], std::string_view name)
+{
+    for (size_t i = 0; i < N; ++i) {
+        if (name == table[i].name) {
+            return i;
+        }
+    }
+    return N;
+}
+
+/*
+ * Typed request dispatch over the services of a table generated by
+ * tools/generate_service_config.py --cpp-header. Table provides:
+ *
+ *   static constexpr RpcServiceInfo services[];
+ *   using Helpers = std::tuple<HakoRpcServiceServerTemplateType(...)...>;
+ *
+ * where Helpers holds the helper type of each service, in table order. A
+ * handler is registered by service index and must accept the request body of
+ * that service and fill its response body; a mismatch is a compile error.
+ * resolve() maps the table's services to ServiceHandles of the server, so a
+ * polled request reaches its handler through the event slot of its service
+ * and a per-index jump table, and is answered through the same handle,
+ * without comparing service names.
+ *
+ * A handler returns true to reply DONE/OK with the response body, false to
+ * reply ERROR/ERROR. A request of a service without a handler is answered
+ * like RpcServiceExecutor does: ERROR for a request, CANCELED for a cancel.
+ */
+template <typename Table>
+class TypedRpcServer {
+public:
+    static constexpr size_t SERVICE_COUNT = std::size(Table::services);
+    static_assert(SERVICE_COUNT == std::tuple_size_v<typename Table::Helpers>,
+                  "Table::Helpers must have one helper type per service");
+
+    template <size_t I>
+    using Helper = std::tuple_element_t<I, typename Table::Helpers>;
+    template <size_t I>
+    using RequestBody = typename Helper<I>::RequestBody;
+    template <size_t I>
+    using ResponseBody = typename Helper<I>::ResponseBody;
+    template <size_t I>
+    using Handler = std::function<bool(const RequestBody<I>& request, ResponseBody<I>& response)>;
+
+    explicit TypedRpcServer(RpcServicesServer& server) : server_(server) {}
+
+    TypedRpcServer(const TypedRpcServer&) = delete;
+    TypedRpcServer& operator=(const TypedRpcServer&) = delete;
+
+    static constexpr size_t index_of(std::string_view service_name)
+    {
+        return rpc_service_index(Table::services, service_name);
+    }
+
+    template <size_t I, typename F>
+    void set_handler(F&& handler)
+    {
+        static_assert(I < SERVICE_COUNT, "service index out of range");
+        static_assert(std::is_invocable_r_v<bool, F&, const RequestBody<I>&, ResponseBody<I>&>,
+                      "handler must be callable as bool(const RequestBody<I>&, ResponseBody<I>&)");
+        std::get<I>(handlers_) = std::forward<F>(handler);
+    }
+
+    /*
+     * Resolves every service of the table on the server, and checks it
+     * against the config the server was initialized from: type, maxClients,
+     * pduSize, and the channels of each client of the table. Logs each
+     * missing service or mismatch and returns false if there is any, as the
+     * table then was generated from another config; requests of a service
+     * that does not match are answered with ERROR instead of reaching its
+     * handler. Call it after the server's initialize_services(); the first
+     * poll calls it otherwise.
+     */
+    bool resolve()
+    {
+        resolve_attempted_ = true;
+        index_of_slot_.clear();
+        bool ok = true;
+        for (size_t i = 0; i < SERVICE_COUNT; ++i) {
+            const RpcServiceInfo& info = Table::services[i];
+            ServiceHandle service = server_.get_service(info.name);
+            const auto* config = server_.get_service_config(service);
+            if (config == nullptr) {
+                std::cerr << "ERROR: Service of the service table is not configured: " << info.name << std::endl;
+                ok = false;
+                continue;
+            }
+            if (!matches_config(info, *config)) {
+                ok = false;
+                continue;
+            }
+            if (service.slot >= index_of_slot_.size()) {
+                index_of_slot_.resize(service.slot + 1, SERVICE_COUNT);
+            }
+            index_of_slot_[service.slot] = i;
+        }
+        return ok;
+    }
+
+    /*
+     * Polls one event of the server and dispatches it. Returns the event, or
+     * NONE when no request was waiting.
+     */
+    ServerEventType poll()
+    {
+        resolve_once();
+        ServiceHandle service;
+        ServerEventType event = server_.poll(service, request_);
+        dispatch(event, service);
+        return event;
+    }
+
+    // Same as poll(), but blocks up to timeout_usec (0: without limit).
+    ServerEventType poll_wait(uint64_t timeout_usec)
+    {
+        resolve_once();
+        ServiceHandle service;
+        ServerEventType event = server_.poll_wait(service, request_, timeout_usec);
+        dispatch(event, service);
+        return event;
+    }
+
+private:
+    template <size_t... I>
+    static auto make_handlers(std::index_sequence<I...>) -> std::tuple<Handler<I>...>;
+    using Handlers = decltype(make_handlers(std::make_index_sequence<SERVICE_COUNT>{}));
+    using DispatchFn = void (TypedRpcServer::*)(ServiceHandle, RpcRequest&);
+
+    template <size_t... I>
+    static constexpr std::array<DispatchFn, SERVICE_COUNT> make_dispatch_table(std::index_sequence<I...>)
+    {
+        return {&TypedRpcServer::handle_request<I>...};
+    }
+
+    void resolve_once()
+    {
+        if (!resolve_attempted_) {
+            resolve();
+        }
+    }
+
+    static bool matches_config(const RpcServiceInfo& info, const RpcServicesServer::ServiceConfig& config)
+    {
+        bool ok = true;
+        auto mismatch = [&](const char* what) {
+            std::cerr << "ERROR: Service table does not match the service config for " << info.name
+                      << ": " << what << " differs" << std::endl;
+            ok = false;
+        };
+        if (config.type != info.type) {
+            mismatch("type");
+        }
+        if (config.max_clients != info.max_clients) {
+            mismatch("maxClients");
+        }
+        if (config.server_base_size != info.server_base_size || config.server_heap_size != info.server_heap_size ||
+            config.client_base_size != info.client_base_size || config.client_heap_size != info.client_heap_size) {
+            mismatch("pduSize");
+        }
+        if (config.dynamic_client) {
+            return ok;
+        }
+        if (config.clients.size() != info.clients.size()) {
+            mismatch("the number of clients");
+        }
+        for (const RpcClientInfo& client : info.clients) {
+            const RpcServicesServer::ServiceConfig::Client* found = nullptr;
+            for (const auto& configured : config.clients) {
+                if (configured.name == client.name) {
+                    found = &configured;
+                    break;
+                }
+            }
+            if (found == nullptr) {
+                std::cerr << "ERROR: Service table client " << client.name << " is not configured for " << info.name << std::endl;
+                ok = false;
+            } else if (found->request_channel_id != client.request_channel_id ||
+                       found->response_channel_id != client.response_channel_id) {
+                std::cerr << "ERROR: Service table does not match the service config for " << info.name
+                          << ": channels of client " << client.name << " differ" << std::endl;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    void dispatch(ServerEventType event, ServiceHandle service)
+    {
+        if (event == ServerEventType::REQUEST_CANCEL) {
+            send_status(service, HAKO_SERVICE_STATUS_DONE, HAKO_SERVICE_RESULT_CODE_CANCELED, true);
+            return;
+        }
+        if (event != ServerEventType::REQUEST_IN) {
+            return;
+        }
+        const size_t index = service.slot < index_of_slot_.size() ? index_of_slot_[service.slot] : SERVICE_COUNT;
+        if (index >= SERVICE_COUNT) {
+            std::cerr << "ERROR: Service not in the service table or not matching it: " << request_.header.service_name << std::endl;
+            send_status(service, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_ERROR, false);
+            return;
+        }
+        static constexpr std::array<DispatchFn, SERVICE_COUNT> dispatch_table =
+            make_dispatch_table(std::make_index_sequence<SERVICE_COUNT>{});
+        (this->*dispatch_table[index])(service, request_);
+    }
+
+    template <size_t I>
+    void handle_request(ServiceHandle service, RpcRequest& request)
+    {
+        auto& handler = std::get<I>(handlers_);
+        if (!handler) {
+            std::cerr << "ERROR: No handler registered for service: " << request.header.service_name << std::endl;
+            send_status(service, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_ERROR, false);
+            return;
+        }
+        Helper<I> helper;
+        RequestBody<I> request_body{};
+        ResponseBody<I> response_body{};
+        if (!helper.get_request_body(request, request_body)) {
+            send_status(service, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_ERROR, false);
+            return;
+        }
+        if (handler(request_body, response_body)) {
+            helper.reply(server_, service, request, HAKO_SERVICE_STATUS_DONE, HAKO_SERVICE_RESULT_CODE_OK, response_body);
+        } else {
+            helper.reply(server_, service, request, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_ERROR, response_body);
+        }
+    }
+
+    void send_status(ServiceHandle service, Hako_uint8 status, Hako_int32 result_code, bool cancel)
+    {
+        server_.create_reply_buffer(service, request_.header, status, result_code, reply_pdu_);
+        if (cancel) {
+            server_.send_cancel_reply(service, request_.header, reply_pdu_);
+        } else {
+            server_.send_reply(service, request_.header, reply_pdu_);
+        }
+    }
+
+    RpcServicesServer& server_;
+    Handlers handlers_;
+    // Service index by event slot; SERVICE_COUNT for services not in Table
+    // or not matching its entry.
+    std::vector<size_t> index_of_slot_;
+    bool resolve_attempted_ = false;
+    RpcRequest request_;
+    PduData reply_pdu_;
+};
+
+} // namespace hakoniwa::pdu::rpc
@@ -5,12 +5,22 @@
 #include "hakoniwa/pdu/endpoint_container.hpp"
 #include "rpc_client_endpoint.hpp" // For IRpcClientEndpoint
 #include "rpc_client_endpoint_impl.hpp" // For RpcClientEndpointImpl
+#include "rpc_event_notifier.hpp"
+#include "rpc_timer_wheel.hpp"
 #include "hakoniwa/time_source/time_source.hpp" // For ITimeSource
 #include <string>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
 #include <optional>
 #include <nlohmann/json_fwd.hpp>
+#include <set>
+#include <span>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace hakoniwa::pdu::rpc {
@@ -40,12 +50,124 @@ public:
      *         Note that `true` does not mean the service call succeeded, only that it was properly started.
      */
     bool call(const std::string& service_name, const PduData& request_pdu, uint64_t timeout_usec);
+    /**
+     * @brief Same as call(), and reports the request_id of the issued request.
+     *
+     * When the service sets "maxInFlight" above 1, several calls may be
+     * outstanding at once. Each gets its own timeout, and the events returned
+     * by `poll` carry the request_id in `response_out.header.request_id`.
+     */
+    bool call(const std::string& service_name, const PduData& request_pdu, uint64_t timeout_usec, Hako_uint32& request_id);
     ClientEventType poll(std::string& service_name, RpcResponse& response_out);
+    /**
+     * @brief Same as poll(), but blocks until an event is available.
+     *
+     * The caller sleeps on a condition variable that is signalled when a
+     * response arrives, and wakes by itself when the earliest in-flight call
+     * reaches its timeout, so RESPONSE_TIMEOUT is reported on time.
+     *
+     * @param timeout_usec Maximum time to block. 0 waits without limit.
+     * @return The event, or ClientEventType::NONE when the timeout expired or
+     *         no call is in flight.
+     */
+    ClientEventType poll_wait(std::string& service_name, RpcResponse& response_out, uint64_t timeout_usec);
+    /**
+     * @brief Drains up to results.size() events in one call.
+     *
+     * Each filled entry holds what poll() would have returned next: the
+     * event, and the response, whose header.service_name and
+     * header.request_id name the call. A timeout is reported once, as by
+     * poll(), so a drain ends when no event is left.
+     *
+     * @return The number of entries filled, from the front of results.
+     */
+    size_t poll_batch(std::span<RpcCallResult> results);
+    // Cancels the most recently issued request that is still in flight.
     bool send_cancel_request(const std::string& service_name);
+    // A timed-out call whose cancel cannot be sent is dropped, as no reply
+    // could complete it any more.
+    bool send_cancel_request(const std::string& service_name, Hako_uint32 request_id);
     bool create_request_buffer(const std::string& service_name, PduData& pdu);
     bool create_request_buffer(const std::string& service_name, Hako_uint8 opcode, PduData& pdu);
+    /**
+     * @brief Writes a REQUEST packet for the service into a caller-owned buffer.
+     *
+     * Avoids allocating a PduData per request. `out_size` receives the packet
+     * size, also when `false` is returned because `capacity` is too small;
+     * it is 0 when the service is unknown.
+     */
+    bool create_request_buffer(const std::string& service_name, uint8_t* buffer, size_t capacity, size_t& out_size);
+    // The service's "maxInFlight" window, or 0 when the service is unknown.
+    size_t get_max_in_flight(const std::string& service_name) const;
+
+    /**
+     * @brief Resolves a service once, for the overloads below.
+     *
+     * They do the same as the name-taking calls, but reach the service's
+     * endpoint by index, so a hot loop does no string lookups.
+     * @return The handle, or an invalid one when the service is unknown.
+     */
+    ServiceHandle get_service(const std::string& service_name) const;
+    bool call(ServiceHandle service, const PduData& request_pdu, uint64_t timeout_usec);
+    bool call(ServiceHandle service, const PduData& request_pdu, uint64_t timeout_usec, Hako_uint32& request_id);
+    // Same as poll() and poll_wait(), but report the service as a handle.
+    ClientEventType poll(ServiceHandle& service, RpcResponse& response_out);
+    ClientEventType poll_wait(ServiceHandle& service, RpcResponse& response_out, uint64_t timeout_usec);
+    bool send_cancel_request(ServiceHandle service);
+    bool send_cancel_request(ServiceHandle service, Hako_uint32 request_id);
+    bool create_request_buffer(ServiceHandle service, PduData& pdu);
+    bool create_request_buffer(ServiceHandle service, uint8_t* buffer, size_t capacity, size_t& out_size);
+
+    using CallCallback = std::function<void(RpcCallResult&& result)>;
+    /**
+     * @brief Calls a service and reports the outcome through a future.
+     *
+     * The future is completed by run_once() or by the event pump thread
+     * (start_event_pump()), so several threads can share one client without
+     * polling it. A call that times out completes with RESPONSE_TIMEOUT, and
+     * its cancel request is sent on the caller's behalf. A request that
+     * cannot be sent gives a future that is already complete with event NONE.
+     *
+     * Once call_async() is used, events are consumed by run_once() or the
+     * pump; do not also poll() the client for calls made with call().
+     */
+    std::future<RpcCallResult> call_async(const std::string& service_name, const PduData& request_pdu, uint64_t timeout_usec);
+    /**
+     * @brief Same as call_async(), but invokes `callback` on completion.
+     *
+     * The callback runs on the thread that completes the call: the pump
+     * thread, or the caller of run_once(). It may issue further calls.
+     * @return false, without invoking the callback, if the request was not sent.
+     */
+    bool call_async(const std::string& service_name, const PduData& request_pdu, uint64_t timeout_usec, CallCallback callback);
+    /**
+     * @brief Completes the async calls whose events are available, blocking in
+     * poll_wait() for up to `timeout_usec` (0: no limit) when none is.
+     *
+     * For applications that drive the client from their own loop instead of
+     * the event pump.
+     * @return The number of calls completed.
+     */
+    size_t run_once(uint64_t timeout_usec);
+    // Starts a thread that runs run_once() while async calls are outstanding.
+    bool start_event_pump();
+    void stop_event_pump();
 
 private:
+    using AsyncCallKey = std::pair<std::string, Hako_uint32>;
+    // How long the pump blocks in poll_wait() before it rechecks for stop.
+    static constexpr uint64_t EVENT_PUMP_WAIT_USEC = 10000;
+    void event_pump_loop();
+    void complete_async_call(ClientEventType event, const std::string& service_name, RpcResponse& response, size_t& completed);
+
+    // Hands the calls whose timer has fired to their endpoints.
+    void expire_call_timers();
+    // poll() and poll_wait() with the event slot of the reporting endpoint.
+    ClientEventType poll_slot(size_t& slot, RpcResponse& response_out);
+    ClientEventType poll_wait_slot(size_t& slot, RpcResponse& response_out, uint64_t timeout_usec);
+    // The endpoint of a handle of this client, or nullptr.
+    IRpcClientEndpoint* endpoint_of(ServiceHandle service, const char* action) const;
+
     std::string node_id_;
     std::string client_name_; // Single client identity
     std::string config_path_;
@@ -56,8 +178,22 @@ private:
     //TODO std::map<std::pair<std::string, std::string>, std::shared_ptr<hakoniwa::pdu::Endpoint>> pdu_endpoints_;
     // RPC client endpoints (service_name) -> endpoint
     std::map<std::string, std::shared_ptr<IRpcClientEndpoint>> rpc_endpoints_;
+    // The same endpoints indexed by their event slot, for the ready list.
+    std::vector<std::shared_ptr<IRpcClientEndpoint>> endpoint_slots_;
     std::shared_ptr<hakoniwa::time_source::ITimeSource> time_source_;
     std::shared_ptr<hakoniwa::pdu::EndpointContainer> endpoint_container_;
+    std::shared_ptr<RpcEventNotifier> event_notifier_ = std::make_shared<RpcEventNotifier>();
+    // Timers of the calls of all endpoints, in time_source_ time.
+    std::shared_ptr<RpcTimerWheel> timer_wheel_;
+
+    // Outstanding call_async() calls, and those that timed out and were
+    // cancelled but whose cancel has not been answered yet.
+    std::mutex async_mtx_;
+    std::condition_variable async_cv_;
+    std::map<AsyncCallKey, CallCallback> async_calls_;
+    std::set<AsyncCallKey> abandoned_calls_;
+    bool event_pump_running_ = false;
+    std::thread event_pump_;
 };
 
 } // namespace hakoniwa::pdu::rpc
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 
 namespace hakoniwa::pdu::rpc {
@@ -39,6 +40,9 @@ public:
     void stop();
 
     ServerEventType poll(RpcMuxRequest& request);
+    // Drains up to requests.size() requests across connections in one call;
+    // see RpcServicesServer::poll_batch(). Returns the number filled.
+    std::size_t poll_batch(std::span<RpcMuxRequest> requests);
 
     bool create_reply_buffer(
         const RpcMuxRequest& request,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "rpc_server_endpoint.hpp"
+#include "rpc_event_notifier.hpp"
 #include "hakoniwa/pdu/endpoint.hpp"
 #include "hakoniwa/pdu/endpoint_container.hpp"
 #include "hakoniwa/time_source/time_source_factory.hpp"
@@ -9,6 +10,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <thread>
 #include <utility>
@@ -18,6 +20,8 @@ namespace hakoniwa::pdu::rpc {
 
 class RpcServicesServer {
 public:
+    static constexpr uint32_t DEFAULT_SERVICE_WEIGHT = 1;
+
     RpcServicesServer(const std::string& node_id, const std::string& impl_type, const std::string& service_config_path, uint64_t delta_time_usec, std::string time_source_type = "real")
         : node_id_(node_id), impl_type_(impl_type), service_config_path_(service_config_path), delta_time_usec_(delta_time_usec)
         {
@@ -48,13 +52,43 @@ public:
         }
     }
 
+    /**
+     * @brief Returns the next request event of any service, or NONE.
+     *
+     * Services with queued requests are served round-robin. A service with
+     * "weight" N in its config may return up to N requests in a row before
+     * the next ready service gets its turn, so a flooded service cannot
+     * starve the others.
+     */
     ServerEventType poll(RpcRequest& request);
+    /**
+     * @brief Drains up to requests.size() events in one call.
+     *
+     * Follows the same round-robin and weights as poll(), but takes a whole
+     * turn of each service under one endpoint lock. Each filled entry is what
+     * poll() would have returned: a cancel has HAKO_SERVICE_OPERATION_CODE_CANCEL
+     * in header.opcode and is what poll() reports as REQUEST_CANCEL.
+     *
+     * @return The number of entries filled, from the front of requests.
+     */
+    size_t poll_batch(std::span<RpcRequest> requests);
+    /**
+     * @brief Same as poll(), but blocks until an event is available.
+     *
+     * The caller sleeps on a condition variable that the endpoint receive
+     * callbacks signal when a request is queued, so it wakes as soon as one
+     * arrives instead of after a polling interval.
+     *
+     * @param timeout_usec Maximum time to block. 0 waits without limit.
+     * @return The event, or ServerEventType::NONE when the timeout expired.
+     */
+    ServerEventType poll_wait(RpcRequest& request, uint64_t timeout_usec);
 
     void send_reply(HakoCpp_ServiceRequestHeader header, const PduData& pdu)
     {
         auto it = rpc_endpoints_.find(header.service_name);
         if (it != rpc_endpoints_.end()) {
-            it->second->send_reply(header.client_name, pdu);
+            it->second->send_reply(header.client_name, header.request_id, pdu);
         } else {
             std::cerr << "ERROR: Service not found for sending reply: " << header.service_name << std::endl;
         }
@@ -63,13 +97,91 @@ public:
     {
         auto it = rpc_endpoints_.find(header.service_name);
         if (it != rpc_endpoints_.end()) {
-            it->second->send_cancel_reply(header.client_name, pdu);
+            it->second->send_cancel_reply(header.client_name, header.request_id, pdu);
         } else {
             std::cerr << "ERROR: Service not found for sending cancel reply: " << header.service_name << std::endl;
         }
     }
 
+    /**
+     * @brief Resolves a service once, for the overloads below.
+     *
+     * They do the same as the calls that take a header's service_name, but
+     * reach the service's endpoint by index, so a hot loop does no string
+     * lookups.
+     * @return The handle, or an invalid one when the service is unknown.
+     */
+    ServiceHandle get_service(const std::string& service_name) const
+    {
+        auto it = rpc_endpoints_.find(service_name);
+        if (it == rpc_endpoints_.end()) {
+            std::cerr << "ERROR: Service '" << service_name << "' not found for resolving a handle." << std::endl;
+            return ServiceHandle{};
+        }
+        return ServiceHandle{this, it->second->get_event_slot()};
+    }
+    // What initialize_services() read for one service from the service config.
+    struct ServiceConfig {
+        struct Client {
+            std::string name;
+            int32_t request_channel_id = 0;
+            int32_t response_channel_id = 0;
+        };
+        std::string type;
+        uint32_t max_clients = 0;
+        size_t server_base_size = 0;
+        size_t server_heap_size = 0;
+        size_t client_base_size = 0;
+        size_t client_heap_size = 0;
+        // Empty for a "dynamicClient" service, whose clients are not listed.
+        bool dynamic_client = false;
+        std::vector<Client> clients;
+    };
+    // The config of a service of this server, or nullptr for an invalid handle.
+    const ServiceConfig* get_service_config(ServiceHandle service) const
+    {
+        if (service.owner != this || service.slot >= endpoint_slots_.size()) {
+            return nullptr;
+        }
+        return &endpoint_slots_[service.slot].config;
+    }
+    // Same as poll() and poll_wait(), and report the service of the event.
+    ServerEventType poll(ServiceHandle& service, RpcRequest& request);
+    ServerEventType poll_wait(ServiceHandle& service, RpcRequest& request, uint64_t timeout_usec);
+    void create_reply_buffer(ServiceHandle service, const HakoCpp_ServiceRequestHeader& header, Hako_uint8 status, Hako_int32 result_code, PduData& pdu)
+    {
+        if (auto* endpoint = endpoint_of(service, "creating reply buffer")) {
+            endpoint->create_reply_buffer(header, status, result_code, pdu);
+        }
+    }
+    void send_reply(ServiceHandle service, const HakoCpp_ServiceRequestHeader& header, const PduData& pdu)
+    {
+        if (auto* endpoint = endpoint_of(service, "sending reply")) {
+            endpoint->send_reply(header.client_name, header.request_id, pdu);
+        }
+    }
+    void send_cancel_reply(ServiceHandle service, const HakoCpp_ServiceRequestHeader& header, const PduData& pdu)
+    {
+        if (auto* endpoint = endpoint_of(service, "sending cancel reply")) {
+            endpoint->send_cancel_reply(header.client_name, header.request_id, pdu);
+        }
+    }
+
 private:
+    // The endpoint of a handle of this server, or nullptr.
+    IRpcServerEndpoint* endpoint_of(ServiceHandle service, const char* action) const
+    {
+        if (service.owner != this || service.slot >= endpoint_slots_.size()) {
+            std::cerr << "ERROR: Invalid service handle for " << action << "." << std::endl;
+            return nullptr;
+        }
+        return endpoint_slots_[service.slot].endpoint.get();
+    }
+    // poll_batch() that also stores the event slot of each filled entry in
+    // slots, when given.
+    size_t poll_batch_slots(std::span<RpcRequest> requests, size_t* slots);
+    ServerEventType poll_wait_slot(size_t& slot, RpcRequest& request, uint64_t timeout_usec);
+
     bool initialize_services_impl(
         std::shared_ptr<hakoniwa::pdu::EndpointContainer> endpoint_container,
         std::shared_ptr<hakoniwa::pdu::Endpoint> endpoint_override,
@@ -77,12 +189,24 @@ private:
 
     //service_name, endpoint
     std::map<std::string, std::shared_ptr<IRpcServerEndpoint>> rpc_endpoints_;
+    // The same endpoints indexed by their event slot, for the ready list.
+    struct ServiceSlot {
+        std::shared_ptr<IRpcServerEndpoint> endpoint;
+        uint32_t weight;
+        ServiceConfig config;
+    };
+    std::vector<ServiceSlot> endpoint_slots_;
+    // Slot whose turn the last poll_batch() ran out of room for, and how many
+    // requests of its weight are left; other ready slots wait behind it.
+    size_t burst_slot_ = 0;
+    uint32_t burst_left_ = 0;
     std::string node_id_;
     std::string impl_type_;
     std::string service_config_path_;
     uint64_t delta_time_usec_;
     std::shared_ptr<hakoniwa::time_source::ITimeSource> time_source_;
     std::shared_ptr<hakoniwa::pdu::EndpointContainer> endpoint_container_;
+    std::shared_ptr<RpcEventNotifier> event_notifier_ = std::make_shared<RpcEventNotifier>();
 };
 
 } // namespace hakoniwa::pdu::rpc
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace hakoniwa::pdu::rpc {
+
+/*
+ * Hierarchical timer wheel for the call timeouts of the endpoints of one
+ * RpcServicesClient.
+ *
+ * Time is whatever the caller passes in, normally the client's ITimeSource,
+ * so virtual time works as well as real time. Deadlines are rounded up to
+ * ticks of tick_usec. Level 0 has one slot per tick; each slot of a higher
+ * level spans a full turn of the level below and is spread over it when that
+ * turn begins. Scheduling and cancelling are O(1), and advance() returns at
+ * once while no tick has passed, so polls that expire nothing pay nothing.
+ *
+ * A timer fires exactly once, unless it is cancelled first. Deadlines beyond
+ * the span of the wheel are parked in its last level and placed again as
+ * time approaches them.
+ */
+class RpcTimerWheel {
+public:
+    // Identifies a scheduled timer for cancel(); 0 is never returned.
+    using TimerId = uint64_t;
+
+    struct Expired {
+        // Chosen by the caller of schedule(); the client uses the endpoint's
+        // event slot and the request_id of the call.
+        size_t owner;
+        uint32_t id;
+    };
+
+    explicit RpcTimerWheel(uint64_t tick_usec);
+
+    // now_usec is the current time of the same clock advance() is driven by.
+    TimerId schedule(uint64_t now_usec, uint64_t deadline_usec, size_t owner, uint32_t id);
+    void cancel(TimerId timer);
+    // Appends the timers whose deadline is at or before now_usec to expired.
+    void advance(uint64_t now_usec, std::vector<Expired>& expired);
+    // Time until advance() can next fire a timer or has to spread a higher
+    // slot: 0 when one is already due, UINT64_MAX when nothing is scheduled.
+    uint64_t usec_until_next(uint64_t now_usec) const;
+    size_t size() const;
+
+private:
+    static constexpr size_t LEVELS = 4;
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint32_t NIL = UINT32_MAX;
+    static constexpr uint32_t DUE_SLOT = LEVELS * SLOTS;
+
+    struct Node {
+        uint64_t deadline_tick = 0;
+        size_t owner = 0;
+        uint32_t id = 0;
+        uint32_t generation = 0;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        // Index into slots_, or NIL while the node is free.
+        uint32_t slot = NIL;
+    };
+
+    uint64_t to_tick_ceil(uint64_t usec) const { return (usec + tick_usec_ - 1) / tick_usec_; }
+    void place(uint32_t index);
+    void link(uint32_t index, uint32_t slot);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void spread(size_t level);
+    void fire_slot(uint32_t slot, std::vector<Expired>& expired);
+    // Ticks in which only empty slots are passed: the rest of the turn of
+    // the lowest levels that hold no timer.
+    uint64_t idle_mask() const;
+
+    const uint64_t tick_usec_;
+    mutable std::mutex mtx_;
+    // The last tick advance() has processed.
+    uint64_t current_tick_ = 0;
+    bool started_ = false;
+    size_t size_ = 0;
+    std::array<size_t, LEVELS> level_size_{};
+    // Heads of the slot lists, level by level; the slot past them holds
+    // timers that were already due when they were scheduled.
+    std::array<uint32_t, LEVELS * SLOTS + 1> slots_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_;
+};
+
+} // namespace hakoniwa::pdu::rpc
@@ -1,28 +1,103 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <type_traits>
 #include <vector>
 #include "hakoniwa/pdu/endpoint_types.h"
+#include "rpc_buffer_pool.hpp"
 #include "hako_srv_msgs/pdu_cpptype_conv_ServiceRequestHeader.hpp"
 #include "hako_srv_msgs/pdu_cpptype_conv_ServiceResponseHeader.hpp"
 #include "pdu_convertor.hpp"
 
 namespace hakoniwa::pdu::rpc {
 
-// Common data types
-using PduData = std::vector<uint8_t>;
+// Common data types (PduData is declared in rpc_buffer_pool.hpp)
+
+/*
+ * Hands a received buffer back to the endpoint pool that supplied it, if that
+ * endpoint is still alive. Called when the owning RpcRequest/RpcResponse is
+ * destroyed or is about to be refilled by poll().
+ */
+inline void release_pdu_buffer(std::weak_ptr<PduBufferPool>& pool, PduData& pdu) noexcept {
+    if (auto owner = pool.lock()) {
+        owner->release(std::move(pdu));
+    }
+    pdu = PduData{};
+    pool.reset();
+}
 
 struct RpcRequest {
     std::string client_name;
     HakoCpp_ServiceRequestHeader header;
     PduData pdu;
+    std::weak_ptr<PduBufferPool> pdu_pool;
+
+    RpcRequest() = default;
+    RpcRequest(const RpcRequest&) = default;
+    RpcRequest(RpcRequest&&) noexcept = default;
+    RpcRequest& operator=(const RpcRequest& other) {
+        if (this != &other) {
+            release_pdu();
+            client_name = other.client_name;
+            header = other.header;
+            pdu = other.pdu;
+            pdu_pool = other.pdu_pool;
+        }
+        return *this;
+    }
+    RpcRequest& operator=(RpcRequest&& other) noexcept {
+        if (this != &other) {
+            release_pdu();
+            client_name = std::move(other.client_name);
+            header = std::move(other.header);
+            pdu = std::move(other.pdu);
+            pdu_pool = std::move(other.pdu_pool);
+        }
+        return *this;
+    }
+    ~RpcRequest() { release_pdu(); }
+    void release_pdu() noexcept { release_pdu_buffer(pdu_pool, pdu); }
 };
 
 struct RpcResponse {
     HakoCpp_ServiceResponseHeader header;
     PduData pdu;
+    std::weak_ptr<PduBufferPool> pdu_pool;
+
+    RpcResponse() = default;
+    RpcResponse(const RpcResponse&) = default;
+    RpcResponse(RpcResponse&&) noexcept = default;
+    RpcResponse& operator=(const RpcResponse& other) {
+        if (this != &other) {
+            release_pdu();
+            header = other.header;
+            pdu = other.pdu;
+            pdu_pool = other.pdu_pool;
+        }
+        return *this;
+    }
+    RpcResponse& operator=(RpcResponse&& other) noexcept {
+        if (this != &other) {
+            release_pdu();
+            header = std::move(other.header);
+            pdu = std::move(other.pdu);
+            pdu_pool = std::move(other.pdu_pool);
+        }
+        return *this;
+    }
+    ~RpcResponse() { release_pdu(); }
+    void release_pdu() noexcept { release_pdu_buffer(pdu_pool, pdu); }
 };
 
+// std::vector and std::deque move these on reallocation only when moving
+// cannot throw; a copy would take the buffer out of its pool.
+static_assert(std::is_nothrow_move_constructible_v<RpcRequest>);
+static_assert(std::is_nothrow_move_assignable_v<RpcRequest>);
+static_assert(std::is_nothrow_move_constructible_v<RpcResponse>);
+static_assert(std::is_nothrow_move_assignable_v<RpcResponse>);
+
 // Corresponds to SERVER_API_EVENT_* in Python
 enum class ServerEventType {
     NONE,
@@ -36,6 +111,30 @@ enum class ClientEventType {
     RESPONSE_TIMEOUT
 };
 
+// Completion of one call made with call_async() or RpcCallScheduler. event is
+// RESPONSE_IN, RESPONSE_CANCEL or RESPONSE_TIMEOUT; NONE means the request
+// could not be sent.
+struct RpcCallResult {
+    ClientEventType event = ClientEventType::NONE;
+    RpcResponse response;
+};
+
+/*
+ * A service of one RpcServicesClient or RpcServicesServer, resolved once by
+ * its get_service(). The overloads that take a handle index the service's
+ * endpoint directly instead of looking its name up. A handle stays valid
+ * while the services are initialized, also across a re-initialization; a
+ * default-constructed handle, or one of another client or server, is
+ * rejected.
+ */
+struct ServiceHandle {
+    const void* owner = nullptr;
+    size_t slot = 0;
+
+    bool valid() const { return owner != nullptr; }
+    bool operator==(const ServiceHandle&) const = default;
+};
+
 /*
  * Operation code to be set by the client when sending a service request.
  * This indicates the type of request the client wants to perform.
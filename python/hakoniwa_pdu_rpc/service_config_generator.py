@@ -303,8 +303,11 @@ def resolve(manifest: dict[str, Any]) -> dict[str, Any]:
 
 
 def _write_json(path: Path, value: Any) -> None:
+    _write_text(path, json.dumps(value, indent=2, ensure_ascii=False) + "\n")
+
+
+def _write_text(path: Path, content: str) -> None:
     path.parent.mkdir(parents=True, exist_ok=True)
-    content = json.dumps(value, indent=2, ensure_ascii=False) + "\n"
     if path.exists() and path.read_text(encoding="utf-8") == content:
         return
     fd, temporary = tempfile.mkstemp(prefix=f".{path.name}.", dir=path.parent)
@@ -320,7 +323,117 @@ def _write_json(path: Path, value: Any) -> None:
         raise
 
 
-def generate(manifest_path: Path, output_dir: Path) -> list[Path]:
+CPP_NAMESPACE_PATTERN = re.compile(r"[A-Za-z_][A-Za-z0-9_]*(::[A-Za-z_][A-Za-z0-9_]*)*")
+
+
+def _cpp_string(value: str) -> str:
+    return json.dumps(value, ensure_ascii=True)
+
+
+def _cpp_helper_type(service_type: str) -> str:
+    package, name = service_type.split("/")
+    if package == "hako_srv_msgs":
+        return f"HakoRpcServiceServerTemplateType({name})"
+    convertor = f"hako::pdu::msgs::{package}"
+    return (
+        "hakoniwa::pdu::rpc::HakoRpcAssetServiceServer<\n"
+        f"            HakoCpp_{name}RequestPacket,\n"
+        f"            HakoCpp_{name}ResponsePacket,\n"
+        f"            HakoCpp_{name}Request,\n"
+        f"            HakoCpp_{name}Response,\n"
+        f"            {convertor}::{name}RequestPacket,\n"
+        f"            {convertor}::{name}ResponsePacket,\n"
+        f"            Hako_{name}RequestPacket,\n"
+        f"            Hako_{name}ResponsePacket,\n"
+        f"            &cpp_cpp2pdu_{name}Request,\n"
+        f"            &cpp_cpp2pdu_{name}Response>"
+    )
+
+
+def render_cpp_header(resolved: dict[str, Any], namespace: str) -> str:
+    """Render the services of a resolved manifest as a TypedRpcServer table."""
+    if not CPP_NAMESPACE_PATTERN.fullmatch(namespace):
+        raise ConfigurationError(f"invalid C++ namespace: {namespace!r}")
+    services = resolved["services"]
+    constants: list[str] = []
+    for service in services:
+        constant = _service_key(service["name"]).upper()
+        if constant[0].isdigit():
+            constant = f"SERVICE_{constant}"
+        if constant in constants:
+            raise ConfigurationError(
+                f"Service '{service['name']}' has the same C++ index name "
+                f"{constant} as another service"
+            )
+        constants.append(constant)
+
+    includes = sorted(
+        {
+            f"{package}/pdu_cpptype_conv_{name}{packet}.hpp"
+            for package, name in (
+                service["type"].split("/") for service in services
+            )
+            for packet in ("RequestPacket", "ResponsePacket")
+        }
+    )
+    lines = [
+        "// Generated by tools/generate_service_config.py. Do not edit.",
+        "#pragma once",
+        "",
+        '#include "hakoniwa/pdu/rpc/rpc_service_table.hpp"',
+        *(f'#include "{include}"' for include in includes),
+        "",
+        "#include <cstddef>",
+        "#include <tuple>",
+        "",
+        f"namespace {namespace} {{",
+        "",
+    ]
+    for constant, service in zip(constants, services):
+        lines.append(
+            f"inline constexpr hakoniwa::pdu::rpc::RpcClientInfo {constant}_CLIENTS[] = {{"
+        )
+        for client in service["clients"]:
+            lines.append(
+                f"    {{{_cpp_string(client['name'])}, "
+                f"{client['requestChannelId']}, {client['responseChannelId']}}},"
+            )
+        lines.extend(("};", ""))
+
+    lines.append("struct ServiceTable {")
+    for index, constant in enumerate(constants):
+        lines.append(f"    static constexpr std::size_t {constant} = {index};")
+    lines.append("    static constexpr hakoniwa::pdu::rpc::RpcServiceInfo services[] = {")
+    for constant, service in zip(constants, services):
+        server = service["pduSize"]["server"]
+        client = service["pduSize"]["client"]
+        lines.append(
+            f"        {{{_cpp_string(service['name'])}, {_cpp_string(service['type'])}, "
+            f"{service['maxClients']}, {server['baseSize']}, {server['heapSize']}, "
+            f"{client['baseSize']}, {client['heapSize']}, {constant}_CLIENTS}},"
+        )
+    lines.append("    };")
+    helpers = ",\n".join(
+        f"        {_cpp_helper_type(service['type'])}" for service in services
+    )
+    lines.extend(
+        (
+            "    using Helpers = std::tuple<",
+            f"{helpers}>;",
+            "};",
+            "",
+            f"}} // namespace {namespace}",
+        )
+    )
+    return "\n".join(lines) + "\n"
+
+
+def generate(
+    manifest_path: Path,
+    output_dir: Path,
+    cpp_header: Path | None = None,
+    cpp_namespace: str = "hakoniwa_service",
+) -> list[Path]:
     try:
         manifest = json.loads(manifest_path.read_text(encoding="utf-8"))
     except OSError as error:
@@ -447,6 +560,10 @@ def generate(manifest_path: Path, output_dir: Path) -> list[Path]:
     endpoints_path = output_dir / "endpoints.json"
     _write_json(endpoints_path, endpoint_entries)
     generated.append(endpoints_path)
+
+    if cpp_header is not None:
+        _write_text(cpp_header, render_cpp_header(resolved, cpp_namespace))
+        generated.append(cpp_header)
     return generated
 
 
@@ -456,9 +573,20 @@ def main() -> int:
     )
     parser.add_argument("--config", required=True, type=Path)
     parser.add_argument("--output", required=True, type=Path)
+    parser.add_argument(
+        "--cpp-header",
+        type=Path,
+        help="also write the Services as a TypedRpcServer table to this C++ header",
+    )
+    parser.add_argument("--cpp-namespace", default="hakoniwa_service")
     args = parser.parse_args()
     try:
-        generated = generate(args.config.resolve(), args.output.resolve())
+        generated = generate(
+            args.config.resolve(),
+            args.output.resolve(),
+            args.cpp_header.resolve() if args.cpp_header else None,
+            args.cpp_namespace,
+        )
     except ConfigurationError as error:
         parser.error(str(error))
     for path in generated:
@@ -80,22 +80,8 @@ bool ActionClientEndpointImpl::create_packet_buffer(
                   << packet_type << "'." << std::endl;
         return false;
     }
-    void* base_ptr = hako_create_empty_pdu(
-        static_cast<int>(base_size),
-        static_cast<int>(heap_capacity));
-    if (base_ptr == nullptr) {
-        return false;
-    }
-    const auto* metadata = hako_get_pdu_meta_data(base_ptr);
-    const void* top_ptr = hako_get_top_ptr_pdu(base_ptr);
-    if (metadata == nullptr || top_ptr == nullptr) {
-        hako_destroy_pdu(base_ptr);
-        return false;
-    }
-    packet_out.resize(metadata->total_size);
-    std::memcpy(packet_out.data(), top_ptr, packet_out.size());
-    hako_destroy_pdu(base_ptr);
-    return true;
+    return packet_arena_.copy_empty_packet(
+        base_size, heap_capacity, packet_out);
 }
 
 bool ActionClientEndpointImpl::validate_packet_capacity(
@@ -148,11 +134,10 @@ bool ActionClientEndpointImpl::write_request_header(
     header.request_kind = request_kind;
     header.reserved = {0, 0};
     header.goal_id = goal_id;
-    PduDynamicMemory dynamic_memory;
     return cpp_cpp2pdu_ActionRequestHeader(
         header,
         *reinterpret_cast<Hako_ActionRequestHeader*>(base_ptr),
-        dynamic_memory);
+        packet_arena_.dynamic_memory());
 }
 
 bool ActionClientEndpointImpl::create_control_request_packet(
@@ -400,7 +385,9 @@ GoalSendResult ActionClientEndpointImpl::send_goal_with_result(
             });
     }
 
-    PduData packet = goal_pdu;
+    const auto scratch_lock = packet_arena_.lock_scratch();
+    PduData& packet = packet_arena_.scratch();
+    packet.assign(goal_pdu.begin(), goal_pdu.end());
     const auto& routing = slot_routing_[slot_index];
     std::size_t wire_size = 0;
     if (!validate_packet_capacity(
@@ -456,7 +443,8 @@ bool ActionClientEndpointImpl::send_cancel(
         committed_binding = binding->second;
     }
 
-    PduData packet;
+    const auto scratch_lock = packet_arena_.lock_scratch();
+    PduData& packet = packet_arena_.scratch();
     if (!create_control_request_packet(packet)
         || committed_binding.slot_index >= slot_routing_.size()) {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "action_configuration.hpp"
+#include "action_packet_arena.hpp"
 #include "hakoniwa/pdu/action/action_client_endpoint.hpp"
 #include "hakoniwa/pdu/endpoint.hpp"
 #include "hakoniwa/time_source/time_source.hpp"
@@ -116,6 +117,7 @@ private:
     std::map<GoalId, ClientPacketBinding> packet_bindings_;
     std::optional<ActionDefinition> action_definition_;
     bool initialized_{false};
+    mutable ActionPacketArena packet_arena_;
 
     bool create_packet_buffer(
         const std::string& packet_type,
@@ -129,6 +131,7 @@ private:
         std::size_t heap_capacity,
         bool require_exact_buffer_size,
         std::size_t& wire_size_out) const;
+    // Called with packet_arena_'s scratch lock held.
     bool write_request_header(
         PduData& packet,
         const GoalId& goal_id,
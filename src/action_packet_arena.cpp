@@ -0,0 +1,55 @@
+#include "action_packet_arena.hpp"
+
+#include "pdu_primitive_ctypes.h"
+
+#include <cstring>
+
+namespace hakoniwa::pdu::action {
+
+bool ActionPacketArena::copy_empty_packet(
+    std::uint32_t base_size,
+    std::size_t heap_capacity,
+    PduData& packet_out)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto key = std::make_pair(base_size, heap_capacity);
+    auto it = empty_packets_.find(key);
+    if (it == empty_packets_.end()) {
+        void* base_ptr = hako_create_empty_pdu(
+            static_cast<int>(base_size),
+            static_cast<int>(heap_capacity));
+        if (base_ptr == nullptr) {
+            return false;
+        }
+        const auto* metadata = hako_get_pdu_meta_data(base_ptr);
+        const void* top_ptr = hako_get_top_ptr_pdu(base_ptr);
+        if (metadata == nullptr || top_ptr == nullptr) {
+            hako_destroy_pdu(base_ptr);
+            return false;
+        }
+        PduData packet(static_cast<std::size_t>(metadata->total_size));
+        std::memcpy(packet.data(), top_ptr, packet.size());
+        hako_destroy_pdu(base_ptr);
+        it = empty_packets_.emplace(key, std::move(packet)).first;
+    }
+    packet_out.assign(it->second.begin(), it->second.end());
+    return true;
+}
+
+std::unique_lock<std::mutex> ActionPacketArena::lock_scratch()
+{
+    return std::unique_lock<std::mutex>(scratch_mutex_);
+}
+
+PduData& ActionPacketArena::scratch()
+{
+    return scratch_;
+}
+
+PduDynamicMemory& ActionPacketArena::dynamic_memory()
+{
+    dynamic_memory_.emplace();
+    return *dynamic_memory_;
+}
+
+} // namespace hakoniwa::pdu::action
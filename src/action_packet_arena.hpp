@@ -0,0 +1,50 @@
+#pragma once
+
+#include "hakoniwa/pdu/action/action_types.hpp"
+#include "pdu_convertor.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace hakoniwa::pdu::action {
+
+/**
+ * Per-endpoint packet storage for the Action endpoints.
+ *
+ * An empty packet of a given base size and heap capacity is built with
+ * hako_create_empty_pdu() once and copied from then on; copying into a
+ * buffer that already has the capacity allocates nothing. scratch() is the
+ * endpoint's buffer for packets that are built and sent within one call, and
+ * dynamic_memory() serves the header conversions of that packet, so
+ * steady-state Goal, Cancel, Feedback and Result traffic reuses memory
+ * instead of allocating a packet per send.
+ */
+class ActionPacketArena {
+public:
+    bool copy_empty_packet(
+        std::uint32_t base_size,
+        std::size_t heap_capacity,
+        PduData& packet_out);
+
+    // Held while a packet is built in scratch() and sent.
+    std::unique_lock<std::mutex> lock_scratch();
+
+    // Call scratch() and dynamic_memory() with lock_scratch() held.
+    PduData& scratch();
+    // Empty again on each call; PduDynamicMemory has no reset of its own, so
+    // it is rebuilt in place.
+    PduDynamicMemory& dynamic_memory();
+
+private:
+    std::mutex mutex_;
+    std::map<std::pair<std::uint32_t, std::size_t>, PduData> empty_packets_;
+    std::mutex scratch_mutex_;
+    PduData scratch_;
+    std::optional<PduDynamicMemory> dynamic_memory_;
+};
+
+} // namespace hakoniwa::pdu::action
@@ -120,11 +120,10 @@ bool ActionServerEndpointImpl::write_response_header(
         return false;
     }
 
-    PduDynamicMemory dynamic_memory;
     return cpp_cpp2pdu_ActionResponseHeader(
         header,
         *reinterpret_cast<Hako_ActionResponseHeader*>(base_ptr),
-        dynamic_memory);
+        packet_arena_.dynamic_memory());
 }
 
 bool ActionServerEndpointImpl::write_feedback_header(
@@ -144,11 +143,10 @@ bool ActionServerEndpointImpl::write_feedback_header(
         return false;
     }
 
-    PduDynamicMemory dynamic_memory;
     return cpp_cpp2pdu_ActionFeedbackHeader(
         header,
         *reinterpret_cast<Hako_ActionFeedbackHeader*>(base_ptr),
-        dynamic_memory);
+        packet_arena_.dynamic_memory());
 }
 
 bool ActionServerEndpointImpl::create_packet_buffer(
@@ -169,24 +167,8 @@ bool ActionServerEndpointImpl::create_packet_buffer(
         return false;
     }
 
-    void* base_ptr = hako_create_empty_pdu(
-        static_cast<int>(base_size),
-        static_cast<int>(heap_capacity));
-    if (base_ptr == nullptr) {
-        return false;
-    }
-
-    auto* metadata = hako_get_pdu_meta_data(base_ptr);
-    void* top_ptr = hako_get_top_ptr_pdu(base_ptr);
-    if (metadata == nullptr || top_ptr == nullptr) {
-        hako_destroy_pdu(base_ptr);
-        return false;
-    }
-
-    packet_out.resize(metadata->total_size);
-    std::memcpy(packet_out.data(), top_ptr, packet_out.size());
-    hako_destroy_pdu(base_ptr);
-    return true;
+    return packet_arena_.copy_empty_packet(
+        base_size, heap_capacity, packet_out);
 }
 
 bool ActionServerEndpointImpl::create_control_response_packet(
@@ -265,7 +247,7 @@ bool ActionServerEndpointImpl::send_response_packet(
     const ActionPacketBinding& binding,
     std::uint8_t response_kind,
     std::uint8_t status,
-    PduData packet)
+    PduData& packet)
 {
     if (binding.slot_index >= slot_routing_.size()) {
         return false;
@@ -323,7 +305,8 @@ void ActionServerEndpointImpl::send_goal_error_reply(
         slot_index,
         PacketBindingState::AWAITING_GOAL_DECISION,
     };
-    PduData response;
+    const auto scratch_lock = packet_arena_.lock_scratch();
+    PduData& response = packet_arena_.scratch();
     if (!create_control_response_packet(response)) {
         std::cerr
             << "ERROR: Failed to create Action Goal rejection reply for action '"
@@ -338,7 +321,7 @@ void ActionServerEndpointImpl::send_goal_error_reply(
             rejected_binding,
             RESPONSE_KIND_GOAL,
             static_cast<std::uint8_t>(Decision::REJECTED),
-            std::move(response))) {
+            response)) {
         std::cerr
             << "ERROR: Failed to send Action Goal rejection reply for action '"
             << action_name_
@@ -762,13 +745,14 @@ bool ActionServerEndpointImpl::accept_goal(const ServerGoalHandle& goal)
             != PacketBindingState::AWAITING_GOAL_DECISION) {
         return false;
     }
-    PduData response;
+    const auto scratch_lock = packet_arena_.lock_scratch();
+    PduData& response = packet_arena_.scratch();
     const bool sent = create_control_response_packet(response)
         && send_response_packet(
             binding->second,
             RESPONSE_KIND_GOAL,
             static_cast<std::uint8_t>(Decision::ACCEPTED),
-            std::move(response));
+            response);
     if (sent) {
         binding->second.state = PacketBindingState::GOAL_ACCEPTED;
     }
@@ -793,13 +777,14 @@ bool ActionServerEndpointImpl::reject_goal(
             != PacketBindingState::AWAITING_GOAL_DECISION) {
         return false;
     }
-    PduData response;
+    const auto scratch_lock = packet_arena_.lock_scratch();
+    PduData& response = packet_arena_.scratch();
     const bool sent = create_control_response_packet(response)
         && send_response_packet(
             binding->second,
             RESPONSE_KIND_GOAL,
             static_cast<std::uint8_t>(Decision::REJECTED),
-            std::move(response));
+            response);
     if (sent) {
         release_binding_locked(binding);
     }
@@ -823,13 +808,14 @@ bool ActionServerEndpointImpl::accept_cancel(
         || !binding->second.cancel_decision_pending) {
         return false;
     }
-    PduData response;
+    const auto scratch_lock = packet_arena_.lock_scratch();
+    PduData& response = packet_arena_.scratch();
     const bool sent = create_control_response_packet(response)
         && send_response_packet(
             binding->second,
             RESPONSE_KIND_CANCEL,
             static_cast<std::uint8_t>(Decision::ACCEPTED),
-            std::move(response));
+            response);
     if (sent) {
         binding->second.state = PacketBindingState::CANCEL_ACCEPTED;
         binding->second.cancel_decision_pending = false;
@@ -882,13 +868,14 @@ bool ActionServerEndpointImpl::reject_cancel(
         || !binding->second.cancel_decision_pending) {
         return false;
     }
-    PduData response;
+    const auto scratch_lock = packet_arena_.lock_scratch();
+    PduData& response = packet_arena_.scratch();
     const bool sent = create_control_response_packet(response)
         && send_response_packet(
             binding->second,
             RESPONSE_KIND_CANCEL,
             static_cast<std::uint8_t>(Decision::REJECTED),
-            std::move(response));
+            response);
     if (sent) {
         binding->second.cancel_decision_pending = false;
     }
@@ -937,7 +924,9 @@ bool ActionServerEndpointImpl::send_feedback(
     }
 
     const auto& routing = slot_routing_[binding->second.slot_index];
-    PduData packet = feedback_pdu;
+    const auto scratch_lock = packet_arena_.lock_scratch();
+    PduData& packet = packet_arena_.scratch();
+    packet.assign(feedback_pdu.begin(), feedback_pdu.end());
     std::size_t wire_size = 0;
     if (!validate_packet_capacity(
             packet,
@@ -997,11 +986,14 @@ CompleteResult ActionServerEndpointImpl::complete(
 
     binding->second.state = PacketBindingState::RESULT_COMMITTED;
     binding->second.cancel_decision_pending = false;
+    const auto scratch_lock = packet_arena_.lock_scratch();
+    PduData& packet = packet_arena_.scratch();
+    packet.assign(result_pdu.begin(), result_pdu.end());
     const bool sent = send_response_packet(
         binding->second,
         RESPONSE_KIND_RESULT,
         static_cast<std::uint8_t>(status),
-        result_pdu);
+        packet);
     if (sent) {
         release_binding_locked(binding);
         return CompleteResult::SENT;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "action_configuration.hpp"
+#include "action_packet_arena.hpp"
 #include "hakoniwa/pdu/action/action_server_endpoint.hpp"
 #include "hakoniwa/pdu/endpoint.hpp"
 #include "hakoniwa/time_source/time_source.hpp"
@@ -149,6 +150,7 @@ private:
     std::map<GoalId, ActionPacketBinding> packet_bindings_;
     std::optional<ActionDefinition> action_definition_;
     bool initialized_{false};
+    ActionPacketArena packet_arena_;
 
     bool decode_request_header(
         const PduData& packet,
@@ -157,6 +159,7 @@ private:
     bool validate_request_header(
         const HakoCpp_ActionRequestHeader& header) const;
 
+    // The header writers are called with packet_arena_'s scratch lock held.
     bool write_response_header(
         PduData& initialized_packet,
         HakoCpp_ActionResponseHeader& header);
@@ -185,7 +188,7 @@ private:
         const ActionPacketBinding& binding,
         std::uint8_t response_kind,
         std::uint8_t status,
-        PduData packet = {});
+        PduData& packet);
 
     void send_goal_error_reply(
         const GoalId& goal_id,
@@ -146,9 +146,9 @@ hako_pdu_rpc_error_t hako_pdu_rpc_client_create_request_buffer(hako_pdu_rpc_clie
 {
     if (!h || !valid_text(service_name) || !out_size) return HAKO_PDU_RPC_ERROR_INVALID_ARGUMENT;
     if (!h->started || !h->rpc) return HAKO_PDU_RPC_ERROR_NOT_RUNNING;
-    PduData pdu;
-    if (!h->rpc->create_request_buffer(service_name, pdu)) return HAKO_PDU_RPC_ERROR_NOT_FOUND;
-    return copy_pdu(pdu, buffer, capacity, out_size);
+    *out_size = 0;
+    if (h->rpc->create_request_buffer(service_name, buffer, capacity, *out_size)) return HAKO_PDU_RPC_OK;
+    return *out_size > 0 ? HAKO_PDU_RPC_ERROR_BUFFER_TOO_SMALL : HAKO_PDU_RPC_ERROR_NOT_FOUND;
 }
 
 hako_pdu_rpc_error_t hako_pdu_rpc_client_call(hako_pdu_rpc_client_handle_t* h, const char* service_name, const uint8_t* pdu, size_t pdu_size, uint64_t timeout_usec)
@@ -226,12 +226,12 @@ hako_pdu_rpc_server_event_t hako_pdu_rpc_server_poll(hako_pdu_rpc_server_handle_
     if (event == ServerEventType::NONE) { *out_size = 0; return HAKO_PDU_RPC_SERVER_EVENT_NONE; }
     const auto result = copy_pdu(request.pdu, buffer, capacity, out_size);
     if (result != HAKO_PDU_RPC_OK) { if (out_error) *out_error = result; return HAKO_PDU_RPC_SERVER_EVENT_NONE; }
-    uint64_t token;
-    { std::lock_guard<std::mutex> lock(h->pending_mutex); token = h->next_token++; h->pending_requests.emplace(token, request); }
-    info->request_token = token;
     copy_name(info->service_name, sizeof(info->service_name), request.header.service_name);
     copy_name(info->client_name, sizeof(info->client_name), request.client_name);
     info->pdu_size = request.pdu.size();
+    uint64_t token;
+    { std::lock_guard<std::mutex> lock(h->pending_mutex); token = h->next_token++; h->pending_requests.emplace(token, std::move(request)); }
+    info->request_token = token;
     return map_server_event(event);
 }
 
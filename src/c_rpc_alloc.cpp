@@ -243,16 +243,16 @@ hako_pdu_rpc_server_event_t hako_pdu_rpc_server_poll_alloc(
             return HAKO_PDU_RPC_SERVER_EVENT_NONE;
         }
 
+        copy_name(info->service_name, sizeof(info->service_name), request.header.service_name);
+        copy_name(info->client_name, sizeof(info->client_name), request.client_name);
+        info->pdu_size = request.pdu.size();
         uint64_t token = 0;
         {
             std::lock_guard<std::mutex> lock(handle->pending_mutex);
             token = handle->next_token++;
-            handle->pending_requests.emplace(token, request);
+            handle->pending_requests.emplace(token, std::move(request));
         }
         info->request_token = token;
-        copy_name(info->service_name, sizeof(info->service_name), request.header.service_name);
-        copy_name(info->client_name, sizeof(info->client_name), request.client_name);
-        info->pdu_size = request.pdu.size();
         return map_server_event(event);
     } catch (...) {
         hako_pdu_rpc_buffer_free(*out_buffer);
@@ -112,13 +112,6 @@ hako_pdu_rpc_error_t store_request(
     RpcMuxRequest request,
     hako_pdu_rpc_request_info_t* info)
 {
-    uint64_t token = 0;
-    {
-        std::lock_guard<std::mutex> lock(handle->pending_mutex);
-        token = handle->next_token++;
-        handle->pending_requests.emplace(token, request);
-    }
-    info->request_token = token;
     copy_name(
         info->service_name,
         sizeof(info->service_name),
@@ -128,6 +121,13 @@ hako_pdu_rpc_error_t store_request(
         sizeof(info->client_name),
         request.request.client_name);
     info->pdu_size = request.request.pdu.size();
+    uint64_t token = 0;
+    {
+        std::lock_guard<std::mutex> lock(handle->pending_mutex);
+        token = handle->next_token++;
+        handle->pending_requests.emplace(token, std::move(request));
+    }
+    info->request_token = token;
     return HAKO_PDU_RPC_OK;
 }
 
@@ -303,7 +303,7 @@ hako_pdu_rpc_server_event_t hako_pdu_rpc_mux_server_poll(
             }
             return HAKO_PDU_RPC_SERVER_EVENT_NONE;
         }
-        (void)store_request(handle, request, info);
+        (void)store_request(handle, std::move(request), info);
         return map_server_event(event);
     } catch (...) {
         if (out_error != nullptr) {
@@ -349,7 +349,7 @@ hako_pdu_rpc_server_event_t hako_pdu_rpc_mux_server_poll_alloc(
             }
             return HAKO_PDU_RPC_SERVER_EVENT_NONE;
         }
-        (void)store_request(handle, request, info);
+        (void)store_request(handle, std::move(request), info);
         return map_server_event(event);
     } catch (...) {
         hako_pdu_rpc_buffer_free(*out_buffer);
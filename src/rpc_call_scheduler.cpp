@@ -0,0 +1,173 @@
+#include "hakoniwa/pdu/rpc/rpc_call_scheduler.hpp"
+
+#include <exception>
+#include <iostream>
+
+namespace hakoniwa::pdu::rpc {
+
+void RpcTask::promise_type::unhandled_exception()
+{
+    try {
+        std::rethrow_exception(std::current_exception());
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: RpcTask threw: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "ERROR: RpcTask threw an unknown exception" << std::endl;
+    }
+}
+
+RpcCallScheduler::RpcCallScheduler(RpcServicesClient& client)
+    : client_(client)
+{
+}
+
+RpcCallScheduler::~RpcCallScheduler()
+{
+    for (void* address : tasks_) {
+        std::coroutine_handle<>::from_address(address).destroy();
+    }
+}
+
+void RpcCallScheduler::spawn(RpcTask task)
+{
+    auto handle = std::exchange(task.handle_, {});
+    if (!handle) {
+        return;
+    }
+    tasks_.insert(handle.address());
+    ready_.push_back(handle);
+}
+
+bool RpcCallScheduler::start_call(CallAwaiter& awaiter, std::coroutine_handle<> handle)
+{
+    awaiter.handle_ = handle;
+    const size_t window = client_.get_max_in_flight(awaiter.service_name_);
+    if (window > 0 && in_flight_[awaiter.service_name_] >= window) {
+        parked_[awaiter.service_name_].push_back(&awaiter);
+        return true;
+    }
+    return issue(awaiter);
+}
+
+bool RpcCallScheduler::issue(CallAwaiter& awaiter)
+{
+    Hako_uint32 request_id = 0;
+    if (!client_.call(awaiter.service_name_, awaiter.request_pdu_, awaiter.timeout_usec_, request_id)) {
+        awaiter.result_.event = ClientEventType::NONE;
+        return false;
+    }
+    ++in_flight_[awaiter.service_name_];
+    waiting_[CallKey(awaiter.service_name_, request_id)] = &awaiter;
+    return true;
+}
+
+void RpcCallScheduler::release_slot(const std::string& service_name)
+{
+    auto& count = in_flight_[service_name];
+    if (count > 0) {
+        --count;
+    }
+    auto it = parked_.find(service_name);
+    if (it == parked_.end()) {
+        return;
+    }
+    const size_t window = client_.get_max_in_flight(service_name);
+    auto& parked = it->second;
+    while (!parked.empty() && count < window) {
+        CallAwaiter* awaiter = parked.front();
+        parked.pop_front();
+        if (!issue(*awaiter)) {
+            ready_.push_back(awaiter->handle_);
+        }
+    }
+}
+
+void RpcCallScheduler::handle_event(ClientEventType event, const std::string& service_name, RpcResponse& response)
+{
+    const CallKey key(service_name, response.header.request_id);
+    auto it = waiting_.find(key);
+    if (event == ClientEventType::RESPONSE_TIMEOUT && it != waiting_.end()) {
+        CallAwaiter* awaiter = it->second;
+        waiting_.erase(it);
+        awaiter->result_.event = event;
+        awaiter->result_.response = std::move(response);
+        ready_.push_back(awaiter->handle_);
+        if (client_.send_cancel_request(service_name, key.second)) {
+            abandoned_.insert(key);
+        } else {
+            // The client has given the call up, so no reply will free its slot.
+            std::cerr << "ERROR: Failed to cancel timed-out request " << key.second
+                      << " of service " << service_name << std::endl;
+            release_slot(service_name);
+        }
+        return;
+    }
+    if (abandoned_.erase(key) > 0) {
+        // The late response or cancel reply of a call that already timed out.
+        release_slot(service_name);
+        return;
+    }
+    if (it == waiting_.end()) {
+        std::cerr << "WARNING: Event for unknown request " << key.second
+                  << " of service " << service_name << std::endl;
+        return;
+    }
+    CallAwaiter* awaiter = it->second;
+    waiting_.erase(it);
+    awaiter->result_.event = event;
+    awaiter->result_.response = std::move(response);
+    ready_.push_back(awaiter->handle_);
+    release_slot(service_name);
+}
+
+void RpcCallScheduler::resume(std::coroutine_handle<> handle)
+{
+    handle.resume();
+    if (handle.done() && tasks_.erase(handle.address()) > 0) {
+        handle.destroy();
+    }
+}
+
+size_t RpcCallScheduler::run_once(uint64_t timeout_usec)
+{
+    std::string service_name;
+    RpcResponse response;
+    for (;;) {
+        const ClientEventType event = client_.poll(service_name, response);
+        if (event == ClientEventType::NONE) {
+            break;
+        }
+        handle_event(event, service_name, response);
+    }
+    if (ready_.empty() && (!waiting_.empty() || !abandoned_.empty())) {
+        const ClientEventType event = client_.poll_wait(service_name, response, timeout_usec);
+        if (event != ClientEventType::NONE) {
+            handle_event(event, service_name, response);
+        }
+    }
+    // Coroutines resumed here may complete further calls at once; those run
+    // in the next pass, so one pass is bounded.
+    size_t resumed = 0;
+    for (size_t n = ready_.size(); n > 0; --n) {
+        auto handle = ready_.front();
+        ready_.pop_front();
+        resume(handle);
+        ++resumed;
+    }
+    return resumed;
+}
+
+bool RpcCallScheduler::run()
+{
+    while (!tasks_.empty()) {
+        if (ready_.empty() && waiting_.empty() && abandoned_.empty()) {
+            std::cerr << "ERROR: RpcCallScheduler has " << tasks_.size()
+                      << " unfinished tasks but no call to wait for" << std::endl;
+            return false;
+        }
+        run_once(0);
+    }
+    return true;
+}
+
+} // namespace hakoniwa::pdu::rpc
@@ -1,7 +1,9 @@
 #include "hakoniwa/pdu/rpc/rpc_client_endpoint_impl.hpp"
+#include "hakoniwa/pdu/rpc/rpc_packet.hpp"
 #include "nlohmann/json.hpp"
 #include <fstream>
 #include <iostream>
+#include <cstddef>
 #include <cstring>
 #include <stdexcept>
 #include <chrono>
@@ -9,26 +11,25 @@
 
 namespace hakoniwa::pdu::rpc {
 
-std::vector<std::shared_ptr<RpcClientEndpointImpl>> RpcClientEndpointImpl::instances_;
+RpcEndpointRegistry<RpcClientEndpointImpl> RpcClientEndpointImpl::instances_;
 
 RpcClientEndpointImpl::RpcClientEndpointImpl(
     const std::string& service_name, const std::string& client_name, uint64_t delta_time_usec,
     const std::shared_ptr<hakoniwa::pdu::Endpoint>& endpoint, std::shared_ptr<hakoniwa::time_source::ITimeSource> time_source)
  : IRpcClientEndpoint(service_name, client_name, delta_time_usec),
-      endpoint_(endpoint), time_source_(time_source), 
-      current_timeout_usec_(0), request_start_time_usec_(0) {
-    
-    client_state_.state = CLIENT_STATE_IDLE;
-    client_state_.request_id = 0;
+      endpoint_(endpoint), time_source_(time_source) {
 }
 
 
 RpcClientEndpointImpl::~RpcClientEndpointImpl() {
-    auto it = std::remove_if(instances_.begin(), instances_.end(),
-        [this](const std::shared_ptr<RpcClientEndpointImpl>& p) {
-            return p.get() == this;
-        });
-    instances_.erase(it, instances_.end());
+    instances_.remove(service_name_, this);
+    calls_finished(in_flight_.size());
+    // The wheel is shared with the endpoint that may replace this one.
+    if (timer_wheel_) {
+        for (const auto& status : in_flight_) {
+            timer_wheel_->cancel(status.timer);
+        }
+    }
 }
 
 bool RpcClientEndpointImpl::initialize(const nlohmann::json& service_config, int pdu_meta_data_size) {
@@ -36,7 +37,7 @@ bool RpcClientEndpointImpl::initialize(const nlohmann::json& service_config, int
         std::cerr << "ERROR: Endpoint is not initialized." << std::endl;
         return false;
     }
-    instances_.push_back(shared_from_this());
+    instances_.add(service_name_, shared_from_this());
 
     try {
         std::string service_name_str = service_config["name"];
@@ -45,6 +46,13 @@ bool RpcClientEndpointImpl::initialize(const nlohmann::json& service_config, int
             return false;
         }
 
+        max_in_flight_ = service_config.value("maxInFlight", DEFAULT_MAX_IN_FLIGHT);
+        if (max_in_flight_ == 0) {
+            std::cerr << "ERROR: 'maxInFlight' must be greater than 0 for service " << service_name_ << std::endl;
+            return false;
+        }
+        in_flight_.reserve(max_in_flight_);
+
         auto pdu_def = endpoint_->get_pdu_definition();
         if (pdu_def == nullptr) {
             std::cerr << "ERROR: PDU Definition is not available in the endpoint." << std::endl;
@@ -66,6 +74,13 @@ bool RpcClientEndpointImpl::initialize(const nlohmann::json& service_config, int
                     + pdu_meta_data_size;
                 req_def.method_type = "RPC";
                 pdu_def->add_definition(service_name_, req_def);
+                request_key_.robot = service_name_;
+                request_key_.channel_id = req_def.channel_id;
+                request_pdu_size_ = req_def.pdu_size;
+                if (!build_request_template()) {
+                    std::cerr << "ERROR: Failed to serialize request header for service " << service_name_ << std::endl;
+                    return false;
+                }
 
                 // Response PDU
                 PduDef res_def;
@@ -77,6 +92,9 @@ bool RpcClientEndpointImpl::initialize(const nlohmann::json& service_config, int
                     + pdu_meta_data_size;
                 res_def.method_type = "RPC";
                 pdu_def->add_definition(service_name_, res_def);
+                // A few buffers beyond the window cover the response being
+                // polled plus those arriving behind it.
+                response_buffer_pool_ = std::make_shared<PduBufferPool>(res_def.pdu_size, max_in_flight_ + RESPONSE_BUFFER_POOL_SIZE);
 
                 //subscribe to response PDU
                 hakoniwa::pdu::PduResolvedKey pdu_resolved_key;
@@ -93,10 +111,7 @@ bool RpcClientEndpointImpl::initialize(const nlohmann::json& service_config, int
                         if (self->endpoint_->get_pdu_name(resolved_pdu_key) != expected_pdu_name) {
                             return;
                         }
-                        PduData pdu_data;
-                        pdu_data.resize(data.size());
-                        std::memcpy(pdu_data.data(), data.data(), data.size());
-                        self->put_pending_response({resolved_pdu_key.robot, expected_pdu_name}, pdu_data);
+                        self->put_pending_response(self->acquire_response_buffer(data));
                 });
 
                 break;
@@ -115,25 +130,64 @@ bool RpcClientEndpointImpl::initialize(const nlohmann::json& service_config, int
 }
 
 void RpcClientEndpointImpl::pdu_recv_callback(const hakoniwa::pdu::PduResolvedKey& resolved_pdu_key, std::span<const std::byte> data) {
-    for (auto& instance : instances_) {
-        if (instance->get_service_name() == resolved_pdu_key.robot) {
-            std::string expected_pdu_name = instance->get_client_name() + "Res";
-            if (instance->endpoint_->get_pdu_name(resolved_pdu_key) == expected_pdu_name) {
-                PduData pdu_data;
-                pdu_data.resize(data.size());
-                std::memcpy(pdu_data.data(), data.data(), data.size());
-                instance->put_pending_response({resolved_pdu_key.robot, expected_pdu_name}, pdu_data);
-                return;
-            }
+    for (auto& instance : instances_.find(resolved_pdu_key.robot)) {
+        std::string expected_pdu_name = instance->get_client_name() + "Res";
+        if (instance->endpoint_->get_pdu_name(resolved_pdu_key) == expected_pdu_name) {
+            instance->put_pending_response(instance->acquire_response_buffer(data));
+            return;
         }
     }
     //std::cerr << "WARNING: Received PDU for unknown client or service: " << resolved_pdu_key.robot << std::endl;
 }
 
+PduData RpcClientEndpointImpl::acquire_response_buffer(std::span<const std::byte> data) {
+    PduData pdu_data = response_buffer_pool_ ? response_buffer_pool_->acquire(data.size()) : PduData(data.size());
+    if (!data.empty()) {
+        std::memcpy(pdu_data.data(), data.data(), data.size());
+    }
+    return pdu_data;
+}
+
+void RpcClientEndpointImpl::release_response_buffer(PduData&& pdu_data) {
+    if (response_buffer_pool_) {
+        response_buffer_pool_->release(std::move(pdu_data));
+    }
+}
+
+void RpcClientEndpointImpl::put_pending_response(PduData&& pdu_data) {
+    // Senders trim packets to metadata.total_size, so only the header has to
+    // be present; anything shorter cannot be decoded.
+    RpcResponseHeaderView header;
+    if (!header.bind(pdu_data.data(), pdu_data.size())) {
+        std::cerr << "WARNING: Discarding malformed response packet: size=" << pdu_data.size() << std::endl;
+        release_response_buffer(std::move(pdu_data));
+        return;
+    }
+    const Hako_uint32 request_id = header.request_id();
+
+    std::lock_guard<std::recursive_mutex> lock(mtx_);
+    // Only in-flight requests can still consume a response. Anything else
+    // is a late reply to a finished request and would never be polled.
+    if (find_in_flight(request_id) == nullptr) {
+        std::cerr << "WARNING: Discarding stale response: request_id=" << request_id << std::endl;
+        release_response_buffer(std::move(pdu_data));
+        return;
+    }
+    auto [it, inserted] = pending_responses_.try_emplace(request_id);
+    if (!inserted) {
+        std::cerr << "WARNING: Discarding duplicate response: request_id=" << request_id << std::endl;
+        release_response_buffer(std::move(pdu_data));
+        return;
+    }
+    it->second = std::move(pdu_data);
+    ready_.push_back(request_id);
+    notify_event();
+}
+
 bool RpcClientEndpointImpl::send_request(const PduData& pdu) {
-    hakoniwa::pdu::PduKey pdu_key = {service_name_, client_name_ + "Req"};
-    std::span<const std::byte> data(reinterpret_cast<const std::byte*>(pdu.data()), pdu.size());
-    auto err = endpoint_->send(pdu_key, data);
+    // Only the used prefix goes on the wire, not the configured heap capacity.
+    std::span<const std::byte> data(reinterpret_cast<const std::byte*>(pdu.data()), rpc_packet_wire_size(pdu.data(), pdu.size()));
+    auto err = endpoint_->send(request_key_, data);
     if (err != HAKO_PDU_ERR_OK) {
         std::cerr << "ERROR: Failed to send request PDU: error=" << static_cast<int>(err) << std::endl;
         return false;
@@ -141,113 +195,324 @@ bool RpcClientEndpointImpl::send_request(const PduData& pdu) {
     return true;
 }
 
+bool RpcClientEndpointImpl::build_request_template() {
+    request_template_.assign(request_pdu_size_, 0);
+    HakoCpp_ServiceRequestHeader request_header;
+    request_header.request_id = 0;
+    request_header.client_name = client_name_;
+    request_header.service_name = service_name_;
+    request_header.opcode = HAKO_SERVICE_OPERATION_CODE_REQUEST;
+    request_header.status_poll_interval_msec = 0;
+    if (convertor_request_.cpp2pdu(request_header, reinterpret_cast<char*>(request_template_.data()),
+            static_cast<int>(request_template_.size())) <= 0) {
+        return false;
+    }
+    // The header is the first member of every request packet, so it starts
+    // at the base offset recorded in the packet metadata.
+    return rpc_packet_base_offset(request_template_.data(), request_template_.size(),
+        sizeof(Hako_ServiceRequestHeader), request_header_off_);
+}
+
+void RpcClientEndpointImpl::patch_request_header(uint8_t* packet, Hako_uint8 opcode, Hako_uint32 request_id) const {
+    uint8_t* header = packet + request_header_off_;
+    std::memcpy(header + offsetof(Hako_ServiceRequestHeader, request_id), &request_id, sizeof(request_id));
+    std::memcpy(header + offsetof(Hako_ServiceRequestHeader, opcode), &opcode, sizeof(opcode));
+}
+
+void RpcClientEndpointImpl::build_request_buffer(Hako_uint8 opcode, Hako_uint32 request_id, PduData& pdu) {
+    // assign() keeps the capacity of a reused buffer, so this is one memcpy.
+    pdu.assign(request_template_.begin(), request_template_.end());
+    if (!pdu.empty()) {
+        patch_request_header(pdu.data(), opcode, request_id);
+    }
+}
+
+Hako_uint32 RpcClientEndpointImpl::next_request_id(bool is_cancel_request) {
+    if (is_cancel_request) {
+        return in_flight_.empty() ? 0 : in_flight_.back().request_id;
+    }
+    return static_cast<Hako_uint32>(++current_request_id_);
+}
+
+bool RpcClientEndpointImpl::create_request_buffer(Hako_uint8 opcode, bool is_cancel_request, uint8_t* buffer, size_t capacity, size_t& out_size) {
+    std::lock_guard<std::recursive_mutex> lock(mtx_);
+    out_size = request_template_.size();
+    if (request_template_.empty() || buffer == nullptr || capacity < out_size) {
+        return false;
+    }
+    std::memcpy(buffer, request_template_.data(), out_size);
+    patch_request_header(buffer, opcode, next_request_id(is_cancel_request));
+    return true;
+}
+
 bool RpcClientEndpointImpl::call(const PduData& pdu, uint64_t timeout_usec) {
+    Hako_uint32 request_id = 0;
+    return call(pdu, timeout_usec, request_id);
+}
+
+bool RpcClientEndpointImpl::call(const PduData& pdu, uint64_t timeout_usec, Hako_uint32& request_id) {
     std::lock_guard<std::recursive_mutex> lock(mtx_);
-    if (client_state_.state != CLIENT_STATE_IDLE) {
+    if (in_flight_.size() >= max_in_flight_) {
         std::cerr << "ERROR: Client is busy" << std::endl;
         return false;
     }
-    client_state_.state = CLIENT_STATE_RUNNING;
-    client_state_.request_id = this->current_request_id_;
-    this->current_timeout_usec_ = timeout_usec;
-    this->request_start_time_usec_ = time_source_->get_microseconds();
+    // The request_id was stamped into the PDU by create_request_buffer(). Read
+    // it back so buffers created ahead of time are tracked under their own id.
+    request_id = static_cast<Hako_uint32>(this->current_request_id_);
+    RpcRequestHeaderView request_header;
+    if (request_header.bind(pdu.data(), pdu.size())) {
+        request_id = request_header.request_id();
+    }
+    if (find_in_flight(request_id) != nullptr) {
+        std::cerr << "ERROR: request_id " << request_id << " is already in flight; create a new request buffer" << std::endl;
+        return false;
+    }
+    ClientProcessingStatus status;
+    status.request_id = request_id;
+    status.state = CLIENT_STATE_RUNNING;
+    status.start_time_usec = time_source_->get_microseconds();
+    status.timeout_usec = timeout_usec;
+    in_flight_.push_back(status);
+    calls_started(1);
 
     // Check if send_request fails
     if (!send_request(pdu)) {
         std::cerr << "ERROR: send_request failed for RPC call." << std::endl;
-        client_state_.state = CLIENT_STATE_IDLE; // Rollback state
+        in_flight_.pop_back(); // Rollback state
+        calls_finished(1);
         return false;
     }
-    //std::cout << "INFO: Sent request with request_id: " << client_state_.request_id << std::endl;
+    //std::cout << "INFO: Sent request with request_id: " << request_id << std::endl;
+    // Without a wheel, poll() checks the elapsed time instead.
+    if (timeout_usec > 0 && timer_wheel_) {
+        // One past the timeout, as the call times out once it is exceeded.
+        in_flight_.back().timer = timer_wheel_->schedule(status.start_time_usec,
+            status.start_time_usec + timeout_usec + 1, event_slot_, request_id);
+    }
+    return true;
+}
 
+bool RpcClientEndpointImpl::send_cancel_request(Hako_uint32 request_id) {
+    std::lock_guard<std::recursive_mutex> lock(mtx_);
+    auto* status = find_in_flight(request_id);
+    if (status == nullptr || status->state != CLIENT_STATE_RUNNING) {
+        std::cerr << "ERROR: Cannot send cancel request, client is not in RUNNING state." << std::endl;
+        return false;
+    }
+    PduData pdu;
+    build_request_buffer(HAKO_SERVICE_OPERATION_CODE_CANCEL, request_id, pdu);
+    bool sent = false;
+    try {
+        sent = send_request(pdu);
+        if (!sent) {
+            std::cerr << "ERROR: send_request failed for cancel request." << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: Failed to send cancel request: " << e.what() << std::endl;
+    }
+    if (!sent) {
+        if (status->timed_out) {
+            // Only the cancel reply could complete a timed-out call, so give
+            // it up rather than hold its window slot forever.
+            std::cerr << "ERROR: Dropping timed-out request " << request_id << " whose cancel could not be sent." << std::endl;
+            auto pending = pending_responses_.find(request_id);
+            if (pending != pending_responses_.end()) {
+                release_response_buffer(std::move(pending->second));
+                pending_responses_.erase(pending);
+            }
+            remove_in_flight(request_id);
+        }
+        return false;
+    }
+    status->state = CLIENT_STATE_CANCELLING;
+    if (pending_responses_.count(request_id) != 0) {
+        // A response held back by the timeout can now be polled.
+        ready_.push_back(request_id);
+        notify_event();
+    }
     return true;
 }
 
+ClientProcessingStatus* RpcClientEndpointImpl::find_in_flight(Hako_uint32 request_id) {
+    for (auto& status : in_flight_) {
+        if (status.request_id == request_id) {
+            return &status;
+        }
+    }
+    return nullptr;
+}
+
+void RpcClientEndpointImpl::remove_in_flight(Hako_uint32 request_id) {
+    for (auto it = in_flight_.begin(); it != in_flight_.end(); ++it) {
+        if (it->request_id == request_id) {
+            if (timer_wheel_) {
+                timer_wheel_->cancel(it->timer);
+            }
+            in_flight_.erase(it);
+            calls_finished(1);
+            return;
+        }
+    }
+}
+
+void RpcClientEndpointImpl::expire_call(Hako_uint32 request_id) {
+    std::lock_guard<std::recursive_mutex> lock(mtx_);
+    auto* status = find_in_flight(request_id);
+    if (status == nullptr || status->state != CLIENT_STATE_RUNNING || status->timed_out) {
+        return;
+    }
+    status->timed_out = true;
+    status->timer = 0;
+    expired_.push_back(request_id);
+    notify_event();
+}
+
+bool RpcClientEndpointImpl::has_in_flight() {
+    std::lock_guard<std::recursive_mutex> lock(mtx_);
+    return !in_flight_.empty();
+}
+
+bool RpcClientEndpointImpl::has_events() const {
+    return !ready_.empty() || !expired_.empty();
+}
+
 ClientEventType RpcClientEndpointImpl::poll(RpcResponse& response) {
     std::lock_guard<std::recursive_mutex> lock(mtx_);
 
-    if (client_state_.state == CLIENT_STATE_IDLE) {
+    if (in_flight_.empty()) {
+        ready_.clear();
+        expired_.clear();
         return ClientEventType::NONE;
     }
+    if (!timer_wheel_) {
+        expire_elapsed_calls();
+    }
+    const ClientEventType event = poll_next(response);
+    // Stay on the ready list while more events are queued.
+    if (has_events()) {
+        notify_event();
+    }
+    return event;
+}
 
-    if (client_state_.state == CLIENT_STATE_RUNNING) {
-        // Match hakoniwa-core-pro semantics: a timeout is an event. The caller
-        // decides whether to issue an explicit cancel request. Keeping the
-        // client RUNNING here also preserves the race where a normal response
-        // can arrive after the timeout event but before cancellation is sent.
-        if (current_timeout_usec_ > 0) {
-            if (time_source_->get_microseconds() - request_start_time_usec_ > current_timeout_usec_) {
-                std::cerr << "ERROR: RPC call timed out" << std::endl;
-                return ClientEventType::RESPONSE_TIMEOUT;
-            }
+void RpcClientEndpointImpl::expire_elapsed_calls() {
+    // Without a timer wheel (an endpoint used outside RpcServicesClient),
+    // poll() compares each call's elapsed time with its timeout instead.
+    // timed_out marks a call that has expired, so it is reported only once.
+    const uint64_t now_usec = time_source_->get_microseconds();
+    for (auto& status : in_flight_) {
+        if (status.timeout_usec == 0 || status.state != CLIENT_STATE_RUNNING || status.timed_out) {
+            continue;
+        }
+        if (now_usec - status.start_time_usec > status.timeout_usec) {
+            status.timed_out = true;
+            expired_.push_back(status.request_id);
         }
     }
+}
 
-    if (client_state_.state == CLIENT_STATE_RUNNING || client_state_.state == CLIENT_STATE_CANCELLING) {
-        // Response check
-        auto it = pending_responses_.begin();
-        while (it != pending_responses_.end()) {
-            HakoCpp_ServiceResponseHeader response_header;
-            convertor_response_.pdu2cpp(reinterpret_cast<char*>(it->pdu_data.data()), response_header);
-            if (response_header.request_id == client_state_.request_id) {
-                response.pdu = std::move(it->pdu_data);
-                response.header = response_header;
-                pending_responses_.erase(it); // Remove the PDU from the queue BEFORE calling handle_response_in
+ClientEventType RpcClientEndpointImpl::poll_next(RpcResponse& response) {
+    // The lock is already held by poll()
+    // Match hakoniwa-core-pro semantics: a timeout is an event. The caller
+    // decides whether to issue an explicit cancel request. Keeping a timed-out
+    // request RUNNING also preserves the race where a normal response can
+    // arrive after the timeout event but before cancellation is sent, so its
+    // response is held back until then.
+    while (!ready_.empty()) {
+        const Hako_uint32 request_id = ready_.front();
+        ready_.pop_front();
+        auto it = pending_responses_.find(request_id);
+        if (it == pending_responses_.end()) {
+            continue; // already polled or cleared
+        }
+        const auto* status = find_in_flight(request_id);
+        if (status == nullptr) {
+            // Its call completed meanwhile.
+            release_response_buffer(std::move(it->second));
+            pending_responses_.erase(it);
+            continue;
+        }
+        if (is_held_back(*status)) {
+            continue; // queued again by send_cancel_request()
+        }
+        response.release_pdu();
+        response.pdu = std::move(it->second);
+        response.pdu_pool = response_buffer_pool_;
+        pending_responses_.erase(it); // Remove the PDU from the table BEFORE calling handle_response_in
 
-                return handle_response_in(response);
-            }
-            ++it;
+        // Bound in put_pending_response(), so this cannot fail.
+        RpcResponseHeaderView header;
+        header.bind(response.pdu.data(), response.pdu.size());
+        return handle_response_in(response, header);
+    }
+    // Each timeout is reported once, when its timer has fired. One that was
+    // cancelled or answered before this poll is dropped.
+    while (!expired_.empty()) {
+        const Hako_uint32 request_id = expired_.front();
+        expired_.pop_front();
+        const auto* status = find_in_flight(request_id);
+        if (status == nullptr || !is_held_back(*status)) {
+            continue;
         }
+        std::cerr << "ERROR: RPC call timed out" << std::endl;
+        // Identify which request timed out; there is no response body.
+        response.release_pdu();
+        response.header = HakoCpp_ServiceResponseHeader{};
+        response.header.request_id = request_id;
+        response.header.service_name = service_name_;
+        response.header.client_name = client_name_;
+        return ClientEventType::RESPONSE_TIMEOUT;
     }
     return ClientEventType::NONE;
 }
 
 
-bool RpcClientEndpointImpl::validate_header(HakoCpp_ServiceResponseHeader& header)
+bool RpcClientEndpointImpl::validate_header(const RpcResponseHeaderView& header)
 {
     // Assuming lock is already held by poll()
-    if (header.service_name != this->service_name_) {
-        std::cerr << "ERROR: service_name is invalid: " << header.service_name << std::endl;
+    if (header.service_name() != this->service_name_) {
+        std::cerr << "ERROR: service_name is invalid: " << header.service_name() << std::endl;
         return false;
     }
-    if (header.client_name != this->client_name_) {
-        std::cerr << "ERROR: client_name is invalid: " << header.client_name << std::endl;
+    if (header.client_name() != this->client_name_) {
+        std::cerr << "ERROR: client_name is invalid: " << header.client_name() << std::endl;
         return false;
     }
-    if (header.request_id != this->client_state_.request_id) {
-        std::cerr << "ERROR: request_id is invalid: " << header.request_id << std::endl;
+    if (find_in_flight(header.request_id()) == nullptr) {
+        std::cerr << "ERROR: request_id is invalid: " << header.request_id() << std::endl;
         return false;
     }
-    if (header.result_code >= HakoServiceResultCode::HAKO_SERVICE_RESULT_CODE_NUM) {
-        std::cerr << "ERROR: result_code is invalid: " << header.result_code << std::endl;
+    if (header.result_code() >= HakoServiceResultCode::HAKO_SERVICE_RESULT_CODE_NUM) {
+        std::cerr << "ERROR: result_code is invalid: " << header.result_code() << std::endl;
         return false;
     }
     return true;
 }
 
-ClientEventType RpcClientEndpointImpl::handle_response_in(RpcResponse& response)
+ClientEventType RpcClientEndpointImpl::handle_response_in(RpcResponse& response, const RpcResponseHeaderView& header)
 {
     // The lock is already held by poll()
-    if (!validate_header(response.header)) {
+    if (!validate_header(header)) {
         std::cerr << "ERROR: Invalid response header during processing" << std::endl;
-        client_state_.state = CLIENT_STATE_IDLE; // Invalidate current request
+        remove_in_flight(header.request_id()); // Invalidate the request
         return ClientEventType::NONE; // Or a dedicated error event
     }
-    
+    // Only a response that is delivered gets its header converted.
+    header.copy_to(response.header);
+
     switch (response.header.result_code) {
         case HAKO_SERVICE_RESULT_CODE_CANCELED:
             return handle_cancel_response(response);
         default:
-            client_state_.state = CLIENT_STATE_IDLE;
+            remove_in_flight(response.header.request_id);
             return ClientEventType::RESPONSE_IN;
     }
 }
 
 ClientEventType RpcClientEndpointImpl::handle_cancel_response(RpcResponse& response)
 {
-    (void)response; // response might be used for logging in the future
-    std::cout << "INFO: RPC request " << client_state_.request_id << " was successfully cancelled." << std::endl;
-    client_state_.state = CLIENT_STATE_IDLE;
+    std::cout << "INFO: RPC request " << response.header.request_id << " was successfully cancelled." << std::endl;
+    remove_in_flight(response.header.request_id);
     return ClientEventType::RESPONSE_CANCEL;
 }
 
@@ -256,10 +521,16 @@ void RpcClientEndpointImpl::clear_all_instances()
     instances_.clear();
 }
 
+size_t RpcClientEndpointImpl::instance_count()
+{
+    return instances_.size();
+}
+
 void RpcClientEndpointImpl::clear_pending_responses()
 {
     std::lock_guard<std::recursive_mutex> lock(mtx_);
     pending_responses_.clear();
+    ready_.clear();
 }
 
 } // namespace hakoniwa::pdu::rpc
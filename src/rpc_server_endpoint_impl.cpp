@@ -1,14 +1,15 @@
 #include "hakoniwa/pdu/rpc/rpc_server_endpoint_impl.hpp"
+#include "hakoniwa/pdu/rpc/rpc_packet.hpp"
 #include "nlohmann/json.hpp"
 #include <fstream>
 #include <iostream>
+#include <cstddef>
 #include <cstring>
 #include <algorithm>
-#include <algorithm>
 
 namespace hakoniwa::pdu::rpc {
 
-std::vector<std::shared_ptr<RpcServerEndpointImpl>> RpcServerEndpointImpl::instances_;
+RpcEndpointRegistry<RpcServerEndpointImpl> RpcServerEndpointImpl::instances_;
 
 RpcServerEndpointImpl::RpcServerEndpointImpl(
     const std::string& service_name, uint64_t delta_time_usec,
@@ -18,11 +19,7 @@ RpcServerEndpointImpl::RpcServerEndpointImpl(
 }
 
 RpcServerEndpointImpl::~RpcServerEndpointImpl() {
-    auto it = std::remove_if(instances_.begin(), instances_.end(),
-        [this](const std::shared_ptr<RpcServerEndpointImpl>& p) {
-            return p.get() == this;
-        });
-    instances_.erase(it, instances_.end());
+    instances_.remove(service_name_, this);
 }
 
 
@@ -31,10 +28,21 @@ bool RpcServerEndpointImpl::initialize(const nlohmann::json& service_config, int
         std::cerr << "ERROR: Endpoint is not initialized." << std::endl;
         return false;
     }
-    instances_.push_back(shared_from_this());
+    instances_.add(service_name_, shared_from_this());
 
     try {
         max_clients_ = service_config["maxClients"].get<size_t>();
+        request_queue_capacity_ = service_config.value("requestQueueCapacity", DEFAULT_REQUEST_QUEUE_CAPACITY);
+        if (request_queue_capacity_ == 0) {
+            std::cerr << "ERROR: 'requestQueueCapacity' must be greater than 0 for service " << service_name_ << std::endl;
+            return false;
+        }
+        max_in_flight_ = service_config.value("maxInFlight", DEFAULT_MAX_IN_FLIGHT);
+        if (max_in_flight_ == 0) {
+            std::cerr << "ERROR: 'maxInFlight' must be greater than 0 for service " << service_name_ << std::endl;
+            return false;
+        }
+        queue_depth_ = service_config.value("queueDepth", DEFAULT_QUEUE_DEPTH);
         std::string service_name = service_config["name"];
         std::string service_type = service_config["type"];
         auto pdu_def = endpoint_->get_pdu_definition();
@@ -42,7 +50,15 @@ bool RpcServerEndpointImpl::initialize(const nlohmann::json& service_config, int
             std::cerr << "ERROR: PDU Definition is not available in the endpoint." << std::endl;
             return false;
         }
+        size_t request_pdu_size = service_config["pduSize"]["server"]["baseSize"].get<size_t>()
+            + service_config["pduSize"]["client"]["heapSize"].get<size_t>()
+            + pdu_meta_data_size;
+        // Each client can have its window and queue of requests plus one cancel outstanding.
+        request_buffer_pool_ = std::make_shared<PduBufferPool>(
+            request_pdu_size, std::min(request_queue_capacity_, max_clients_ * (max_in_flight_ + queue_depth_ + 1)));
         dynamic_client_ = service_config.value("dynamicClient", false);
+        client_ids_.reserve(max_clients_);
+        client_states_.reserve(max_clients_);
         if (dynamic_client_) {
             dynamic_request_channel_id_ = service_config["requestChannelId"];
             dynamic_response_channel_id_ = service_config["responseChannelId"];
@@ -73,10 +89,7 @@ bool RpcServerEndpointImpl::initialize(const nlohmann::json& service_config, int
                     }
                     std::string pdu_name = self->endpoint_->get_pdu_name(resolved_pdu_key);
                     hakoniwa::pdu::PduKey pdu_key = {resolved_pdu_key.robot, pdu_name};
-                    PduData pdu_data = {};
-                    pdu_data.resize(data.size());
-                    std::memcpy(pdu_data.data(), data.data(), data.size());
-                    self->put_pending_request(pdu_key, pdu_data);
+                    self->put_pending_request(pdu_key, self->acquire_request_buffer(data));
             });
             return true;
         }
@@ -95,10 +108,6 @@ bool RpcServerEndpointImpl::initialize(const nlohmann::json& service_config, int
                 std::cout << "INFO: Skipping client " << client_name << " for nodeId " << client["client_endpoint"]["nodeId"] << std::endl;
                 continue;
             }
-            registered_clients_.push_back(client_name);
-            // Initialize server state
-            server_states_[client_name].state = SERVER_STATE_IDLE;
-            server_states_[client_name].request_id = 0;
 
             // Request PDU
             PduDef req_def;
@@ -121,6 +130,7 @@ bool RpcServerEndpointImpl::initialize(const nlohmann::json& service_config, int
                 + pdu_meta_data_size;
             res_def.method_type = "RPC";
             pdu_def->add_definition(service_name, res_def);
+            register_client(client_name, res_def.channel_id, res_def.pdu_size);
 
             //subscribe to request PDU
             hakoniwa::pdu::PduResolvedKey pdu_resolved_key;
@@ -135,10 +145,7 @@ bool RpcServerEndpointImpl::initialize(const nlohmann::json& service_config, int
                     }
                     std::string pdu_name = self->endpoint_->get_pdu_name(resolved_pdu_key);
                     hakoniwa::pdu::PduKey pdu_key = {resolved_pdu_key.robot, pdu_name};
-                    PduData pdu_data = {};
-                    pdu_data.resize(data.size());
-                    std::memcpy(pdu_data.data(), data.data(), data.size());
-                    self->put_pending_request(pdu_key, pdu_data);
+                    self->put_pending_request(pdu_key, self->acquire_request_buffer(data));
             });
         }
     } catch (const nlohmann::json::exception& e) {
@@ -153,20 +160,13 @@ void RpcServerEndpointImpl::pdu_recv_callback(const hakoniwa::pdu::PduResolvedKe
 {
     //std::cout << "INFO: Received PDU for service: " << resolved_pdu_key.robot << std::endl;
     //std::cout << " DEBUG: instance count: " << instances_.size() << std::endl;
-    for (const auto& instance : instances_) {
-        // robot_name = service_name
-        if (instance->get_service_name() != resolved_pdu_key.robot) {
-            //std::cout << "INFO: Skipping PDU for service: " << resolved_pdu_key.robot << ", does not match instance service: " << instance->get_service_name() << std::endl;
-            continue;
-        }
+    // robot_name = service_name
+    for (const auto& instance : instances_.find(resolved_pdu_key.robot)) {
         assert(instance->endpoint_ != nullptr);
         // channel_Id = client_request_channel_id
         std::string pdu_name = instance->endpoint_->get_pdu_name(resolved_pdu_key);
         hakoniwa::pdu::PduKey pdu_key = {resolved_pdu_key.robot, pdu_name};
-        PduData pdu_data = {};
-        pdu_data.resize(data.size());
-        std::memcpy(pdu_data.data(), data.data(), data.size());
-        instance->put_pending_request(pdu_key, pdu_data);
+        instance->put_pending_request(pdu_key, instance->acquire_request_buffer(data));
         //std::cout << "INFO: instance(" << instance->get_service_name() << ")PDU stored for service: " << resolved_pdu_key.robot << std::endl;
         return;
     }
@@ -174,135 +174,372 @@ void RpcServerEndpointImpl::pdu_recv_callback(const hakoniwa::pdu::PduResolvedKe
 }
 
 
-ServerEventType RpcServerEndpointImpl::poll(RpcRequest& request) 
+ServerEventType RpcServerEndpointImpl::poll(RpcRequest& request)
+{
+    std::lock_guard<std::recursive_mutex> lock(mtx_);
+    const ServerEventType event = poll_next(request);
+    // One request is handled per call; stay on the ready list until the
+    // queues are drained.
+    if (has_queued_requests()) {
+        notify_event();
+    }
+    return event;
+}
+
+size_t RpcServerEndpointImpl::poll_batch(std::span<RpcRequest> requests)
 {
     std::lock_guard<std::recursive_mutex> lock(mtx_);
+    size_t count = 0;
+    while (count < requests.size() && has_queued_requests()) {
+        // A packet that is rejected or queued behind its client's window
+        // yields NONE; its slot is reused for the next one.
+        if (poll_next(requests[count]) != ServerEventType::NONE) {
+            ++count;
+        }
+    }
+    if (has_queued_requests()) {
+        notify_event();
+    }
+    return count;
+}
+
+ServerEventType RpcServerEndpointImpl::poll_next(RpcRequest& request)
+{
+    // The lock is already held by poll()
+    if (!released_requests_.empty()) {
+        // Already validated and admitted to its client's window by send_reply.
+        request = std::move(released_requests_.front());
+        released_requests_.pop_front();
+        return ServerEventType::REQUEST_IN;
+    }
     if (pending_requests_.empty()) {
         //std::cout << "INFO: No pending requests to process. : service_name=" << service_name_ << std::endl;
         return ServerEventType::NONE;
     }
     PendingRequest pending_request = std::move(pending_requests_.front());
-    pending_requests_.erase(pending_requests_.begin());
+    pending_requests_.pop_front();
+    request.release_pdu();
     request.pdu = std::move(pending_request.pdu_data);
-
-    convertor_request_.pdu2cpp(reinterpret_cast<char*>(request.pdu.data()), request.header);
-    if (!validate_header(request.header)) {
-        std::cerr << "ERROR: Invalid request header received and ignored" << std::endl;
-        //ignore invalid request
-        send_error_reply(request.header, HAKO_SERVICE_RESULT_CODE_ERROR);
+    request.pdu_pool = request_buffer_pool_;
+    // Senders trim packets to metadata.total_size, so only the header has to
+    // be present. Without one there is no client to send an error reply to.
+    // The header is read in place; it is converted into request.header only
+    // once the request is handed to the application or queued.
+    RpcRequestHeaderView header;
+    if (!header.bind(request.pdu.data(), request.pdu.size())) {
+        std::cerr << "ERROR: Malformed request packet ignored: size=" << request.pdu.size() << std::endl;
+        request.release_pdu();
         return ServerEventType::NONE;
     }
-    // Check if client_name exists in server_states_ before accessing
-    if (server_states_.count(request.header.client_name) == 0) {
-        std::cerr << "ERROR: Unknown client_name in request header: " << request.header.client_name << std::endl;
-        send_error_reply(request.header, HAKO_SERVICE_RESULT_CODE_INVALID);
+    size_t client_id = INVALID_CLIENT_ID;
+    if (!validate_header(header, client_id)) {
+        std::cerr << "ERROR: Invalid request header received and ignored" << std::endl;
+        //ignore invalid request
+        client_id = find_client_id(header.client_name());
+        if (client_id == INVALID_CLIENT_ID) {
+            std::cerr << "ERROR: Unknown client_name: " << header.client_name() << std::endl;
+        } else {
+            send_header_reply(client_states_[client_id], header.request_id(), HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_ERROR);
+        }
         return ServerEventType::NONE;
     }
+    auto& client = client_states_[client_id];
 
-    if (request.header.opcode == HAKO_SERVICE_OPERATION_CODE_CANCEL) {
-        std::cout << "INFO: Received cancel request for client: " << request.header.client_name << std::endl;
-        return handle_cancel_request(request);
+    if (header.opcode() == HAKO_SERVICE_OPERATION_CODE_CANCEL) {
+        std::cout << "INFO: Received cancel request for client: " << header.client_name() << std::endl;
+        return handle_cancel_request(request, header, client);
     }
     else { // REQUEST
-        //std::cout << "INFO: Received request for client: " << request.header.client_name << std::endl;
-        return handle_request_in(request);
+        //std::cout << "INFO: Received request for client: " << header.client_name() << std::endl;
+        return handle_request_in(request, header, client);
     }
 }
 
 void RpcServerEndpointImpl::send_reply(std::string client_name, const PduData& pdu) {
     std::lock_guard<std::recursive_mutex> lock(mtx_);
-
-    if (server_states_.find(client_name) == server_states_.end()) {
+    size_t client_id = find_client_id(client_name);
+    if (client_id == INVALID_CLIENT_ID) {
         std::cerr << "ERROR: Unknown client_name: " << client_name << std::endl;
         return;
     }
-    else if (server_states_[client_name].state == ServerState::SERVER_STATE_IDLE) {
+    Hako_uint32 request_id = 0;
+    if (!resolve_reply_request_id(client_states_[client_id], pdu, request_id)) {
         std::cerr << "ERROR: Cannot send reply, server state is IDLE for client: " << client_name << std::endl;
         return;
     }
+    send_reply(client_name, request_id, pdu);
+}
+
+void RpcServerEndpointImpl::send_reply(std::string client_name, Hako_uint32 request_id, const PduData& pdu) {
+    std::lock_guard<std::recursive_mutex> lock(mtx_);
+
+    size_t client_id = find_client_id(client_name);
+    if (client_id == INVALID_CLIENT_ID) {
+        std::cerr << "ERROR: Unknown client_name: " << client_name << std::endl;
+        return;
+    }
+    auto& client = client_states_[client_id];
+    auto* status = find_in_flight(client, request_id);
+    if (status == nullptr) {
+        std::cerr << "ERROR: Cannot send reply, request_id " << request_id << " is not in flight for client: " << client_name << std::endl;
+        return;
+    }
     
-    server_states_[client_name].state = ServerState::SERVER_STATE_IDLE;
-    server_states_[client_name].request_id = 0;
+    complete_in_flight(client, status);
     //std::cout << "INFO: Reset state to IDLE for client: " << client_name << std::endl;
 
-    hakoniwa::pdu::PduKey pdu_key = {service_name_, client_name + "Res"};
-    std::span<const std::byte> data(reinterpret_cast<const std::byte*>(pdu.data()), pdu.size());
-    auto error = endpoint_->send(pdu_key,  data);
-    if (error != HAKO_PDU_ERR_OK) {
-        std::cerr << "ERROR: Failed to send reply to client_name: " << client_name << ", error: " << static_cast<int>(error) << std::endl;
+    send_response_pdu(client, pdu);
+}
+
+void RpcServerEndpointImpl::send_cancel_reply(std::string client_name, const PduData& pdu) {
+    std::lock_guard<std::recursive_mutex> lock(mtx_);
+    size_t client_id = find_client_id(client_name);
+    if (client_id == INVALID_CLIENT_ID) {
+        std::cerr << "ERROR: Unknown client_name: " << client_name << std::endl;
+        return;
     }
-    else {
-        //std::cout << "INFO: Sent reply to client_name: " << client_name << std::endl;
+    Hako_uint32 request_id = 0;
+    if (!resolve_reply_request_id(client_states_[client_id], pdu, request_id)) {
+        std::cerr << "ERROR: Cannot send reply, server state is not CANCELLING for client: " << client_name << std::endl;
+        return;
     }
+    send_cancel_reply(client_name, request_id, pdu);
 }
 
-void RpcServerEndpointImpl::send_cancel_reply(std::string client_name, const PduData& pdu) {
+void RpcServerEndpointImpl::send_cancel_reply(std::string client_name, Hako_uint32 request_id, const PduData& pdu) {
     // Similar to send_reply, but with a CANCELED result code
     std::lock_guard<std::recursive_mutex> lock(mtx_);
-    if (server_states_.find(client_name) == server_states_.end()) {
+    size_t client_id = find_client_id(client_name);
+    if (client_id == INVALID_CLIENT_ID) {
         std::cerr << "ERROR: Unknown client_name: " << client_name << std::endl;
         return;
     }
-    else if (server_states_[client_name].state != ServerState::SERVER_STATE_CANCELLING) {
+    auto& client = client_states_[client_id];
+    auto* status = find_in_flight(client, request_id);
+    if (status == nullptr || status->state != ServerState::SERVER_STATE_CANCELLING) {
         std::cerr << "ERROR: Cannot send reply, server state is not CANCELLING for client: " << client_name << std::endl;
         return;
     }
     
-    // Reset server state to IDLE
-    server_states_[client_name].state = ServerState::SERVER_STATE_IDLE;
-    server_states_[client_name].request_id = 0;
+    // The request leaves the client's in-flight window
+    complete_in_flight(client, status);
     std::cout << "INFO: Reset state to IDLE for client: " << client_name << " after cancellation" << std::endl;
 
-    hakoniwa::pdu::PduKey pdu_key = {service_name_, client_name + "Res"};
-    std::span<const std::byte> data(reinterpret_cast<const std::byte*>(pdu.data()), pdu.size());
-    auto error = endpoint_->send(pdu_key,  data);
+    send_response_pdu(client, pdu);
+    std::cout << "INFO: Sent cancel reply to client_name: " << client_name << std::endl;
+}
+
+bool RpcServerEndpointImpl::resolve_reply_request_id(const ClientEntry& client, const PduData& pdu, Hako_uint32& request_id) {
+    if (client.in_flight.empty()) {
+        return false;
+    }
+    if (client.in_flight.size() == 1) {
+        request_id = client.in_flight.front().request_id;
+        return true;
+    }
+    // Several requests are in flight: the reply header says which one it answers.
+    RpcResponseHeaderView response_header;
+    if (!response_header.bind(pdu.data(), pdu.size())) {
+        std::cerr << "ERROR: Reply packet has no valid response header for client: " << client.client_name << std::endl;
+        return false;
+    }
+    request_id = response_header.request_id();
+    return true;
+}
+
+void RpcServerEndpointImpl::complete_in_flight(ClientEntry& client, ServerProcessingStatus* status) {
+    client.in_flight.erase(client.in_flight.begin() + (status - client.in_flight.data()));
+    if (client.queued.empty()) {
+        return;
+    }
+    // Admit the oldest queued request into the freed slot.
+    RpcRequest& next = client.queued.front();
+    ServerProcessingStatus next_status;
+    next_status.state = ServerState::SERVER_STATE_RUNNING;
+    next_status.request_id = next.header.request_id;
+    client.in_flight.push_back(next_status);
+    released_requests_.push_back(std::move(next));
+    client.queued.pop_front();
+    notify_event();
+}
+
+ServerProcessingStatus* RpcServerEndpointImpl::find_in_flight(ClientEntry& client, Hako_uint32 request_id) {
+    for (auto& status : client.in_flight) {
+        if (status.request_id == request_id) {
+            return &status;
+        }
+    }
+    return nullptr;
+}
+
+void RpcServerEndpointImpl::send_response_pdu(const ClientEntry& client, const PduData& pdu) {
+    // Only the used prefix goes on the wire, not the configured heap capacity.
+    std::span<const std::byte> data(reinterpret_cast<const std::byte*>(pdu.data()), rpc_packet_wire_size(pdu.data(), pdu.size()));
+    auto error = endpoint_->send(client.response_key, data);
     if (error != HAKO_PDU_ERR_OK) {
-        std::cerr << "ERROR: Failed to send reply to client_name: " << client_name << ", error: " << static_cast<int>(error) << std::endl;
+        std::cerr << "ERROR: Failed to send reply to client_name: " << client.client_name << ", error: " << static_cast<int>(error) << std::endl;
     }
-    std::cout << "INFO: Sent cancel reply to client_name: " << client_name << std::endl;
 }
 
-bool RpcServerEndpointImpl::validate_header(HakoCpp_ServiceRequestHeader& header)
+bool RpcServerEndpointImpl::serialize_reply_header(const HakoCpp_ServiceResponseHeader& response_header, size_t response_pdu_size, PduData& pdu) {
+    pdu.assign(response_pdu_size, 0);
+    return convertor_response_.cpp2pdu(response_header, reinterpret_cast<char*>(pdu.data()),
+        static_cast<int>(response_pdu_size)) > 0;
+}
+
+bool RpcServerEndpointImpl::build_reply_template(ClientEntry& client) {
+    HakoCpp_ServiceResponseHeader response_header;
+    response_header.request_id = 0;
+    response_header.client_name = client.client_name;
+    response_header.service_name = service_name_;
+    response_header.status = HAKO_SERVICE_STATUS_NONE;
+    response_header.processing_percentage = 100;
+    response_header.result_code = HAKO_SERVICE_RESULT_CODE_OK;
+    if (!serialize_reply_header(response_header, client.response_pdu_size, client.reply_template)) {
+        client.reply_template.clear();
+        return false;
+    }
+    // The header is the first member of every response packet, so it starts
+    // at the base offset recorded in the packet metadata.
+    if (!rpc_packet_base_offset(client.reply_template.data(), client.reply_template.size(),
+            sizeof(Hako_ServiceResponseHeader), client.reply_header_off)) {
+        client.reply_template.clear();
+        return false;
+    }
+    client.header_reply.reserve(client.reply_template.size());
+    return true;
+}
+
+void RpcServerEndpointImpl::patch_reply_header(const ClientEntry& client, uint8_t* packet, Hako_uint32 request_id, Hako_uint8 status, Hako_int32 result_code) {
+    const Hako_uint8 processing_percentage = 100;
+    uint8_t* header = packet + client.reply_header_off;
+    std::memcpy(header + offsetof(Hako_ServiceResponseHeader, request_id), &request_id, sizeof(request_id));
+    std::memcpy(header + offsetof(Hako_ServiceResponseHeader, status), &status, sizeof(status));
+    std::memcpy(header + offsetof(Hako_ServiceResponseHeader, processing_percentage), &processing_percentage, sizeof(processing_percentage));
+    std::memcpy(header + offsetof(Hako_ServiceResponseHeader, result_code), &result_code, sizeof(result_code));
+}
+
+void RpcServerEndpointImpl::create_reply_buffer(const HakoCpp_ServiceRequestHeader& header, Hako_uint8 status, Hako_int32 result_code, PduData& pdu) {
+    {
+        std::lock_guard<std::recursive_mutex> lock(mtx_);
+        size_t client_id = find_client_id(header.client_name);
+        if (client_id != INVALID_CLIENT_ID && !client_states_[client_id].reply_template.empty()) {
+            const auto& client = client_states_[client_id];
+            // assign() keeps the capacity of a reused buffer, so this is one memcpy.
+            pdu.assign(client.reply_template.begin(), client.reply_template.end());
+            patch_reply_header(client, pdu.data(), header.request_id, status, result_code);
+            return;
+        }
+    }
+    // Error replies to unregistered clients still serialize the full header.
+    HakoCpp_ServiceResponseHeader response_header;
+    response_header.request_id = header.request_id;
+    response_header.client_name = header.client_name;
+    response_header.service_name = header.service_name;
+    response_header.status = status;
+    response_header.processing_percentage = 100;
+    response_header.result_code = result_code;
+    PduKey pdu_key = {header.service_name, header.client_name + "Res"};
+    (void)serialize_reply_header(response_header, endpoint_->get_pdu_size(pdu_key), pdu);
+}
+
+void RpcServerEndpointImpl::send_error_reply(const HakoCpp_ServiceRequestHeader& header, Hako_int32 result_code) {
+    std::lock_guard<std::recursive_mutex> lock(mtx_);
+    size_t client_id = find_client_id(header.client_name);
+    if (client_id == INVALID_CLIENT_ID) {
+        std::cerr << "ERROR: Unknown client_name: " << header.client_name << std::endl;
+        return;
+    }
+    send_header_reply(client_states_[client_id], header.request_id, HAKO_SERVICE_STATUS_ERROR, result_code);
+}
+
+void RpcServerEndpointImpl::send_header_reply(ClientEntry& client, Hako_uint32 request_id, Hako_uint8 status, Hako_int32 result_code) {
+    if (client.reply_template.empty()) {
+        HakoCpp_ServiceRequestHeader header;
+        header.request_id = request_id;
+        header.service_name = service_name_;
+        header.client_name = client.client_name;
+        PduData pdu;
+        create_reply_buffer(header, status, result_code, pdu);
+        send_response_pdu(client, pdu);
+        return;
+    }
+    client.header_reply.assign(client.reply_template.begin(), client.reply_template.end());
+    patch_reply_header(client, client.header_reply.data(), request_id, status, result_code);
+    send_response_pdu(client, client.header_reply);
+}
+
+size_t RpcServerEndpointImpl::register_client(const std::string& client_name, HakoPduChannelIdType response_channel_id, size_t response_pdu_size)
+{
+    auto [it, inserted] = client_ids_.try_emplace(client_name, client_states_.size());
+    if (inserted) {
+        ClientEntry entry;
+        entry.client_name = client_name;
+        entry.in_flight.reserve(max_in_flight_);
+        entry.response_key.robot = service_name_;
+        entry.response_key.channel_id = response_channel_id;
+        entry.response_pdu_size = response_pdu_size;
+        entry.reply_header_off = 0;
+        if (!build_reply_template(entry)) {
+            std::cerr << "WARNING: Failed to serialize reply header for client_name: " << client_name << std::endl;
+        }
+        client_states_.push_back(std::move(entry));
+    }
+    return it->second;
+}
+
+size_t RpcServerEndpointImpl::find_client_id(std::string_view client_name) const
+{
+    auto it = client_ids_.find(client_name);
+    return (it == client_ids_.end()) ? INVALID_CLIENT_ID : it->second;
+}
+
+bool RpcServerEndpointImpl::validate_header(const RpcRequestHeaderView& header, size_t& client_id)
 {
-    if (header.service_name != this->service_name_) {
-        std::cerr << "ERROR: service_name is invalid: " << header.service_name << std::endl;
+    if (header.service_name() != this->service_name_) {
+        std::cerr << "ERROR: service_name is invalid: " << header.service_name() << std::endl;
         return false;
     }
     if (dynamic_client_) {
-        return ensure_dynamic_client(header.client_name);
+        client_id = ensure_dynamic_client(header.client_name());
+        return client_id != INVALID_CLIENT_ID;
     }
-    if (std::find(registered_clients_.begin(), registered_clients_.end(), header.client_name) == registered_clients_.end()) {
-        std::cerr << "ERROR: client_name is invalid: " << header.client_name << std::endl;
+    client_id = find_client_id(header.client_name());
+    if (client_id == INVALID_CLIENT_ID) {
+        std::cerr << "ERROR: client_name is invalid: " << header.client_name() << std::endl;
         return false;
     }
-    if (header.opcode >= HakoServiceOperationCode::HAKO_SERVICE_OPERATION_NUM) {
-        std::cerr << "ERROR: opcode is invalid: " << header.opcode << std::endl;
+    if (header.opcode() >= HakoServiceOperationCode::HAKO_SERVICE_OPERATION_NUM) {
+        std::cerr << "ERROR: opcode is invalid: " << static_cast<int>(header.opcode()) << std::endl;
         return false;
     }
     return true;
 } 
 
-bool RpcServerEndpointImpl::ensure_dynamic_client(const std::string& client_name)
+size_t RpcServerEndpointImpl::ensure_dynamic_client(std::string_view client_name)
 {
     if (client_name.empty()) {
         std::cerr << "ERROR: client_name is empty." << std::endl;
-        return false;
+        return INVALID_CLIENT_ID;
     }
-    if (server_states_.find(client_name) != server_states_.end()) {
-        return true;
+    size_t client_id = find_client_id(client_name);
+    if (client_id != INVALID_CLIENT_ID) {
+        return client_id;
     }
-    if (registered_clients_.size() >= max_clients_) {
+    if (client_states_.size() >= max_clients_) {
         std::cerr << "ERROR: dynamic client limit reached for service: " << service_name_ << std::endl;
-        return false;
+        return INVALID_CLIENT_ID;
     }
     auto pdu_def = endpoint_->get_pdu_definition();
     if (pdu_def == nullptr) {
         std::cerr << "ERROR: PDU Definition is not available in the endpoint." << std::endl;
-        return false;
+        return INVALID_CLIENT_ID;
     }
+    // First request from this client: only now is its name copied.
+    const std::string name(client_name);
 
     PduDef req_def;
-    req_def.org_name = client_name + "Req";
+    req_def.org_name = name + "Req";
     req_def.name = service_name_ + "_" + req_def.org_name;
     req_def.channel_id = dynamic_request_channel_id_;
     req_def.pdu_size = dynamic_request_pdu_size_;
@@ -310,63 +547,95 @@ bool RpcServerEndpointImpl::ensure_dynamic_client(const std::string& client_name
     pdu_def->add_definition(service_name_, req_def);
 
     PduDef res_def;
-    res_def.org_name = client_name + "Res";
+    res_def.org_name = name + "Res";
     res_def.name = service_name_ + "_" + res_def.org_name;
     res_def.channel_id = dynamic_response_channel_id_;
     res_def.pdu_size = dynamic_response_pdu_size_;
     res_def.method_type = "RPC";
     pdu_def->add_definition(service_name_, res_def);
 
-    registered_clients_.push_back(client_name);
-    server_states_[client_name].state = SERVER_STATE_IDLE;
-    server_states_[client_name].request_id = 0;
-    return true;
+    return register_client(name, res_def.channel_id, res_def.pdu_size);
 }
 
 
-ServerEventType RpcServerEndpointImpl::handle_request_in(RpcRequest& request) {
-    if (server_states_[request.header.client_name].state == ServerState::SERVER_STATE_IDLE) {
-        //std::cout << "INFO: Received request for client: " << request.header.client_name << std::endl;
-        server_states_[request.header.client_name].state = ServerState::SERVER_STATE_RUNNING;
-        server_states_[request.header.client_name].request_id = request.header.request_id;
-        request.client_name = request.header.client_name;
+void RpcServerEndpointImpl::accept_request(RpcRequest& request, const RpcRequestHeaderView& header) {
+    // Assigning into the caller's RpcRequest reuses its string capacity.
+    header.copy_to(request.header);
+    request.client_name.assign(header.client_name());
+}
+
+ServerEventType RpcServerEndpointImpl::handle_request_in(RpcRequest& request, const RpcRequestHeaderView& header, ClientEntry& client) {
+    const Hako_uint32 request_id = header.request_id();
+    auto is_queued = [&client](Hako_uint32 request_id) {
+        for (const auto& queued : client.queued) {
+            if (queued.header.request_id == request_id) {
+                return true;
+            }
+        }
+        return false;
+    };
+    if (find_in_flight(client, request_id) != nullptr || is_queued(request_id)) {
+        std::cerr << "WARNING: Received request with a request_id that is still in flight for client: " << client.client_name << std::endl;
+        send_header_reply(client, request_id, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_BUSY);
+        return ServerEventType::NONE;
+    }
+    if (client.in_flight.size() < max_in_flight_) {
+        //std::cout << "INFO: Received request for client: " << client.client_name << std::endl;
+        ServerProcessingStatus status;
+        status.state = ServerState::SERVER_STATE_RUNNING;
+        status.request_id = request_id;
+        client.in_flight.push_back(status);
+        accept_request(request, header);
         return ServerEventType::REQUEST_IN;
     }
-    else if (server_states_[request.header.client_name].state == ServerState::SERVER_STATE_RUNNING) {
-        std::cerr << "WARNING: Received request while previous request is still running for client: " << request.header.client_name << std::endl;
-        send_error_reply(request.header, HAKO_SERVICE_RESULT_CODE_BUSY);
+    else if (client.queued.size() < queue_depth_) {
+        // Held until send_reply frees a slot for this client.
+        accept_request(request, header);
+        client.queued.push_back(std::move(request));
         return ServerEventType::NONE;
     }
-    else { // CANCELING
-        std::cerr << "WARNING: Received request while previous request is cancelling for client: " << request.header.client_name << std::endl;
-        send_error_reply(request.header, HAKO_SERVICE_RESULT_CODE_BUSY);
+    else {
+        std::cerr << "WARNING: Received request while " << client.in_flight.size()
+                  << " previous request(s) are still in flight for client: " << client.client_name << std::endl;
+        send_header_reply(client, request_id, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_BUSY);
         return ServerEventType::NONE;
     }
 }
 
-ServerEventType RpcServerEndpointImpl::handle_cancel_request(RpcRequest& request) {
-    if (server_states_[request.header.client_name].state == ServerState::SERVER_STATE_RUNNING) {
-        if (server_states_[request.header.client_name].request_id != request.header.request_id) {
-            // Request ID does not match
-            std::cerr << "WARNING: Received cancel request with mismatched request_id for client: " << request.header.client_name << std::endl;
-            send_error_reply(request.header, HAKO_SERVICE_RESULT_CODE_INVALID);
+ServerEventType RpcServerEndpointImpl::handle_cancel_request(RpcRequest& request, const RpcRequestHeaderView& header, ClientEntry& client) {
+    const Hako_uint32 request_id = header.request_id();
+    auto* status = find_in_flight(client, request_id);
+    if (status == nullptr) {
+        for (auto it = client.queued.begin(); it != client.queued.end(); ++it) {
+            if (it->header.request_id == request_id) {
+                // The application never saw this request, so cancel it here.
+                std::cout << "INFO: Cancelled queued request for client: " << client.client_name << std::endl;
+                client.queued.erase(it);
+                send_header_reply(client, request_id, HAKO_SERVICE_STATUS_DONE, HAKO_SERVICE_RESULT_CODE_CANCELED);
+                return ServerEventType::NONE;
+            }
+        }
+        if (client.in_flight.empty()) {
+            // Already idle, nothing to cancel
+            // client must get normal reply and cancel request must be ignored
+            std::cerr << "WARNING: Received cancel request while idle for client: " << client.client_name << std::endl;
             return ServerEventType::NONE;
         }
-        server_states_[request.header.client_name].state = ServerState::SERVER_STATE_CANCELLING;
-        std::cout << "INFO: Received cancel request for client: " << request.header.client_name << std::endl;
-        return ServerEventType::REQUEST_CANCEL;
-    }
-    else if (server_states_[request.header.client_name].state == ServerState::SERVER_STATE_IDLE) {
-        // Already idle, nothing to cancel
-        // client must get normal reply and cancel request must be ignored
-        std::cerr << "WARNING: Received cancel request while idle for client: " << request.header.client_name << std::endl;
+        // Request ID does not match
+        std::cerr << "WARNING: Received cancel request with mismatched request_id for client: " << client.client_name << std::endl;
+        send_header_reply(client, request_id, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_INVALID);
         return ServerEventType::NONE;
     }
+    if (status->state == ServerState::SERVER_STATE_RUNNING) {
+        status->state = ServerState::SERVER_STATE_CANCELLING;
+        accept_request(request, header);
+        std::cout << "INFO: Received cancel request for client: " << client.client_name << std::endl;
+        return ServerEventType::REQUEST_CANCEL;
+    }
     else {
         // Already cancelling
-        //TODO reply busy reply
-        std::cerr << "WARNING: Received cancel request while already cancelling for client: " << request.header.client_name << std::endl;
-        send_error_reply(request.header, HAKO_SERVICE_RESULT_CODE_BUSY);
+        std::cerr << "WARNING: Received cancel request while already cancelling for client: " << client.client_name << std::endl;
+        send_header_reply(client, request_id, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_BUSY);
         return ServerEventType::NONE;
     }
 }
@@ -375,6 +644,28 @@ void RpcServerEndpointImpl::clear_pending_requests()
 {
     std::lock_guard<std::recursive_mutex> lock(mtx_);
     pending_requests_.clear();
+    // Admitted requests the application never polled are answered ERROR, so
+    // their callers do not wait for a timeout. Released requests also hold a
+    // slot of their client's window, which nothing would free otherwise.
+    for (const auto& request : released_requests_) {
+        size_t client_id = find_client_id(request.client_name);
+        if (client_id == INVALID_CLIENT_ID) {
+            continue;
+        }
+        auto& client = client_states_[client_id];
+        auto* status = find_in_flight(client, request.header.request_id);
+        if (status != nullptr) {
+            client.in_flight.erase(client.in_flight.begin() + (status - client.in_flight.data()));
+        }
+        send_header_reply(client, request.header.request_id, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_ERROR);
+    }
+    released_requests_.clear();
+    for (auto& client : client_states_) {
+        for (const auto& request : client.queued) {
+            send_header_reply(client, request.header.request_id, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_ERROR);
+        }
+        client.queued.clear();
+    }
 }
 
 } // namespace hakoniwa::pdu::rpc
@@ -0,0 +1,248 @@
+#include "hakoniwa/pdu/rpc/rpc_service_executor.hpp"
+
+#include <exception>
+#include <iostream>
+#include <span>
+#include <utility>
+
+namespace hakoniwa::pdu::rpc {
+
+RpcServiceExecutor::RpcServiceExecutor(RpcServicesServer& server, size_t worker_count)
+    : server_(server), worker_count_(worker_count)
+{
+}
+
+RpcServiceExecutor::~RpcServiceExecutor()
+{
+    stop();
+}
+
+bool RpcServiceExecutor::register_handler(const std::string& service_name, Handler handler)
+{
+    if (running_) {
+        std::cerr << "ERROR: Cannot register a handler while the executor is running: " << service_name << std::endl;
+        return false;
+    }
+    handlers_[service_name] = std::move(handler);
+    return true;
+}
+
+bool RpcServiceExecutor::register_cancel_handler(const std::string& service_name, Handler handler)
+{
+    if (running_) {
+        std::cerr << "ERROR: Cannot register a cancel handler while the executor is running: " << service_name << std::endl;
+        return false;
+    }
+    cancel_handlers_[service_name] = std::move(handler);
+    return true;
+}
+
+bool RpcServiceExecutor::start()
+{
+    if (running_) {
+        return true;
+    }
+    if (worker_count_ == 0) {
+        std::cerr << "ERROR: RpcServiceExecutor needs at least one worker." << std::endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopping_ = false;
+    }
+    running_ = true;
+    workers_.reserve(worker_count_);
+    for (size_t i = 0; i < worker_count_; ++i) {
+        workers_.emplace_back(&RpcServiceExecutor::worker_loop, this);
+    }
+    dispatcher_ = std::thread(&RpcServiceExecutor::dispatch_loop, this);
+    return true;
+}
+
+void RpcServiceExecutor::stop()
+{
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    if (dispatcher_.joinable()) {
+        dispatcher_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void RpcServiceExecutor::dispatch_loop()
+{
+    std::vector<RpcRequest> batch(DISPATCH_BATCH_SIZE);
+    while (running_) {
+        RpcRequest request;
+        const ServerEventType event = server_.poll_wait(request, DISPATCH_WAIT_USEC);
+        if (event == ServerEventType::NONE) {
+            continue;
+        }
+        dispatch(event, std::move(request));
+        // Take whatever else is queued without waiting again.
+        const size_t count = server_.poll_batch(std::span<RpcRequest>(batch));
+        for (size_t i = 0; i < count; ++i) {
+            const ServerEventType batch_event = batch[i].header.opcode == HAKO_SERVICE_OPERATION_CODE_CANCEL
+                ? ServerEventType::REQUEST_CANCEL : ServerEventType::REQUEST_IN;
+            dispatch(batch_event, std::move(batch[i]));
+        }
+    }
+}
+
+std::string RpcServiceExecutor::strand_key(const RpcRequest& request)
+{
+    std::string key = request.header.service_name;
+    key += '\n';
+    key += request.header.client_name;
+    return key;
+}
+
+bool RpcServiceExecutor::cancel_requested(const RpcRequest& request)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = strands_.find(strand_key(request));
+    if (it == strands_.end()) {
+        return false;
+    }
+    const Strand& strand = it->second;
+    return strand.running && strand.running_request_id == request.header.request_id && strand.cancel_requested;
+}
+
+void RpcServiceExecutor::dispatch(ServerEventType event, RpcRequest&& request)
+{
+    if (event == ServerEventType::REQUEST_CANCEL) {
+        dispatch_cancel(std::move(request));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        Strand& strand = strands_[strand_key(request)];
+        strand.tasks.push_back(Task{event, std::move(request)});
+        if (strand.scheduled) {
+            // A worker picks the task up once the earlier ones are done.
+            return;
+        }
+        strand.scheduled = true;
+        runnable_.push_back(&strand);
+    }
+    cv_.notify_one();
+}
+
+void RpcServiceExecutor::dispatch_cancel(RpcRequest&& request)
+{
+    const bool has_handler = cancel_handlers_.count(request.header.service_name) != 0;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto it = strands_.find(strand_key(request));
+        if (it != strands_.end()) {
+            Strand& strand = it->second;
+            if (strand.running && strand.running_request_id == request.header.request_id) {
+                strand.cancel_requested = true;
+            } else {
+                // Not started yet: it must not run once the cancel is answered.
+                for (auto task = strand.tasks.begin(); task != strand.tasks.end(); ++task) {
+                    if (task->request.header.request_id == request.header.request_id) {
+                        strand.tasks.erase(task);
+                        break;
+                    }
+                }
+            }
+        }
+        if (has_handler) {
+            cancels_.push_back(Task{ServerEventType::REQUEST_CANCEL, std::move(request)});
+        }
+    }
+    if (has_handler) {
+        cv_.notify_one();
+        return;
+    }
+    PduData pdu;
+    server_.create_reply_buffer(request.header, HAKO_SERVICE_STATUS_DONE, HAKO_SERVICE_RESULT_CODE_CANCELED, pdu);
+    server_.send_cancel_reply(request.header, pdu);
+}
+
+void RpcServiceExecutor::worker_loop()
+{
+    for (;;) {
+        Strand* strand = nullptr;
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait(lock, [this] { return stopping_ || !cancels_.empty() || !runnable_.empty(); });
+            if (!cancels_.empty()) {
+                task = std::move(cancels_.front());
+                cancels_.pop_front();
+            } else if (!runnable_.empty()) {
+                strand = runnable_.front();
+                runnable_.pop_front();
+                if (strand->tasks.empty()) {
+                    // Its remaining tasks were cancelled before they started.
+                    strand->scheduled = false;
+                    continue;
+                }
+                task = std::move(strand->tasks.front());
+                strand->tasks.pop_front();
+                strand->running = true;
+                strand->running_request_id = task.request.header.request_id;
+                strand->cancel_requested = false;
+            } else {
+                return; // stopping, and everything dispatched has run
+            }
+        }
+        run(task);
+        if (strand == nullptr) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            strand->running = false;
+            strand->cancel_requested = false;
+            if (strand->tasks.empty()) {
+                strand->scheduled = false;
+                continue;
+            }
+            // Back of the queue, so other strands get their turn first.
+            runnable_.push_back(strand);
+        }
+        cv_.notify_one();
+    }
+}
+
+void RpcServiceExecutor::run(Task& task)
+{
+    const auto& handlers = task.event == ServerEventType::REQUEST_CANCEL ? cancel_handlers_ : handlers_;
+    auto it = handlers.find(task.request.header.service_name);
+    if (it == handlers.end()) {
+        std::cerr << "ERROR: No handler registered for service: " << task.request.header.service_name << std::endl;
+        reply_error(task.request);
+        return;
+    }
+    try {
+        it->second(server_, task.request);
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: Handler for service " << task.request.header.service_name << " threw: " << e.what() << std::endl;
+        reply_error(task.request);
+    } catch (...) {
+        std::cerr << "ERROR: Handler for service " << task.request.header.service_name << " threw." << std::endl;
+        reply_error(task.request);
+    }
+}
+
+void RpcServiceExecutor::reply_error(RpcRequest& request)
+{
+    PduData pdu;
+    server_.create_reply_buffer(request.header, HAKO_SERVICE_STATUS_ERROR, HAKO_SERVICE_RESULT_CODE_ERROR, pdu);
+    server_.send_reply(request.header, pdu);
+}
+
+} // namespace hakoniwa::pdu::rpc
@@ -1,6 +1,9 @@
 #include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
 #include "nlohmann/json.hpp"
 #include "hakoniwa/time_source/time_source_factory.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
@@ -13,6 +16,7 @@ namespace hakoniwa::pdu::rpc {
 RpcServicesClient::RpcServicesClient(const std::string& node_id, const std::string& client_name, const std::string& config_path, const std::string& impl_type, uint64_t delta_time_usec, std::string time_source_type)
     : node_id_(node_id), client_name_(client_name), config_path_(config_path), impl_type_(impl_type), delta_time_usec_(delta_time_usec) {
         time_source_ = hakoniwa::time_source::create_time_source(time_source_type, delta_time_usec);
+        timer_wheel_ = std::make_shared<RpcTimerWheel>(delta_time_usec);
         #ifdef ENABLE_DEBUG_MESSAGES
         std::cout << "DEBUG: node_id_: " << node_id_ << ", client_name_: " << client_name_ << ", config_path_: " << config_path_ << ", impl_type_: " << impl_type_ << ", delta_time_usec_: " << delta_time_usec_ << ", time_source_type: " << time_source_type << std::endl;
         #endif
@@ -83,6 +87,12 @@ bool RpcServicesClient::initialize_services(std::shared_ptr<hakoniwa::pdu::Endpo
             std::shared_ptr<IRpcClientEndpoint> rpc_client_endpoint = 
                 std::make_shared<RpcClientEndpointImpl>(service_name, client_name_, delta_time_usec_, pdu_endpoint, time_source_);
             
+            // A re-initialized service keeps the slot of the endpoint it replaces.
+            auto existing = rpc_endpoints_.find(service_name);
+            const size_t slot = existing != rpc_endpoints_.end()
+                ? existing->second->get_event_slot() : endpoint_slots_.size();
+            rpc_client_endpoint->set_event_notifier(event_notifier_, slot);
+            rpc_client_endpoint->set_timer_wheel(timer_wheel_);
             if (!rpc_client_endpoint->initialize(service_entry, pdu_meta_data_size)) {
                 std::cerr << "ERROR: Failed to initialize RPC client endpoint for service " << service_name << std::endl;
                 std::cout.flush();
@@ -90,6 +100,11 @@ bool RpcServicesClient::initialize_services(std::shared_ptr<hakoniwa::pdu::Endpo
                 return false;
             }
             rpc_endpoints_[service_name] = rpc_client_endpoint; // Keyed by service_name
+            if (slot == endpoint_slots_.size()) {
+                endpoint_slots_.push_back(rpc_client_endpoint);
+            } else {
+                endpoint_slots_[slot] = rpc_client_endpoint;
+            }
             std::cout << "INFO: Successfully initialized client for service: " << service_name << " on node " << this->node_id_ << std::endl;
             std::cout.flush();
         }
@@ -108,6 +123,7 @@ bool RpcServicesClient::start_all_services() {
 }
 
 void RpcServicesClient::stop_all_services() {
+    stop_event_pump();
     //pdu_endpoints must be stop on caller's responsibility
     for (auto& endpoint_pair : rpc_endpoints_) {
         endpoint_pair.second->clear_pending_responses();
@@ -123,17 +139,124 @@ bool RpcServicesClient::call(const std::string& service_name, const PduData& req
     return it->second->call(request_pdu, timeout_usec);
 }
 
+bool RpcServicesClient::call(const std::string& service_name, const PduData& request_pdu, uint64_t timeout_usec, Hako_uint32& request_id) {
+    auto it = rpc_endpoints_.find(service_name);
+    if (it == rpc_endpoints_.end()) {
+        std::cerr << "ERROR: Service '" << service_name << "' not found for RPC call." << std::endl;
+        return false;
+    }
+    return it->second->call(request_pdu, timeout_usec, request_id);
+}
+
+void RpcServicesClient::expire_call_timers() {
+    // Returns at once unless a tick has passed, and allocates only when a
+    // timer fires.
+    std::vector<RpcTimerWheel::Expired> expired;
+    timer_wheel_->advance(time_source_->get_microseconds(), expired);
+    for (const auto& timer : expired) {
+        if (timer.owner < endpoint_slots_.size()) {
+            endpoint_slots_[timer.owner]->expire_call(timer.id);
+        }
+    }
+}
+
 ClientEventType RpcServicesClient::poll(std::string& service_name, RpcResponse& response_out) {
-    for (auto& entry : rpc_endpoints_) {
-        ClientEventType event_type = entry.second->poll(response_out);
+    size_t slot = 0;
+    ClientEventType event_type = poll_slot(slot, response_out);
+    if (event_type != ClientEventType::NONE) {
+        service_name = endpoint_slots_[slot]->get_service_name();
+    }
+    return event_type;
+}
+
+ClientEventType RpcServicesClient::poll(ServiceHandle& service, RpcResponse& response_out) {
+    size_t slot = 0;
+    ClientEventType event_type = poll_slot(slot, response_out);
+    if (event_type != ClientEventType::NONE) {
+        service = ServiceHandle{this, slot};
+    }
+    return event_type;
+}
+
+ClientEventType RpcServicesClient::poll_slot(size_t& slot, RpcResponse& response_out) {
+    // Only endpoints with a queued response or an expired call timer are
+    // listed, so an idle poll does not lock every service.
+    expire_call_timers();
+    while (event_notifier_->pop_ready(slot)) {
+        if (slot >= endpoint_slots_.size()) {
+            continue; // from an endpoint that failed to initialize
+        }
+        ClientEventType event_type = endpoint_slots_[slot]->poll(response_out);
         if (event_type != ClientEventType::NONE) {
-            service_name = entry.first; // service_name is the key
             return event_type;
         }
     }
     return ClientEventType::NONE;
 }
 
+size_t RpcServicesClient::poll_batch(std::span<RpcCallResult> results) {
+    size_t count = 0;
+    size_t slot = 0;
+    while (count < results.size()) {
+        RpcCallResult& result = results[count];
+        result.event = poll_slot(slot, result.response);
+        if (result.event == ClientEventType::NONE) {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
+ClientEventType RpcServicesClient::poll_wait(std::string& service_name, RpcResponse& response_out, uint64_t timeout_usec) {
+    size_t slot = 0;
+    ClientEventType event_type = poll_wait_slot(slot, response_out, timeout_usec);
+    if (event_type != ClientEventType::NONE) {
+        service_name = endpoint_slots_[slot]->get_service_name();
+    }
+    return event_type;
+}
+
+ClientEventType RpcServicesClient::poll_wait(ServiceHandle& service, RpcResponse& response_out, uint64_t timeout_usec) {
+    size_t slot = 0;
+    ClientEventType event_type = poll_wait_slot(slot, response_out, timeout_usec);
+    if (event_type != ClientEventType::NONE) {
+        service = ServiceHandle{this, slot};
+    }
+    return event_type;
+}
+
+ClientEventType RpcServicesClient::poll_wait_slot(size_t& slot, RpcResponse& response_out, uint64_t timeout_usec) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_usec);
+    while (true) {
+        // Read the sequence before polling so a response that arrives in
+        // between still ends the wait.
+        const uint64_t seen = event_notifier_->sequence();
+        ClientEventType event_type = poll_slot(slot, response_out);
+        if (event_type != ClientEventType::NONE) {
+            return event_type;
+        }
+        if (event_notifier_->in_flight() == 0) {
+            // Nothing can arrive that poll() would report.
+            return ClientEventType::NONE;
+        }
+        uint64_t wait_usec = timer_wheel_->usec_until_next(time_source_->get_microseconds());
+        if (timeout_usec > 0) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return ClientEventType::NONE;
+            }
+            const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count();
+            wait_usec = std::min(wait_usec, static_cast<uint64_t>(remaining));
+        }
+        if (wait_usec == UINT64_MAX) {
+            event_notifier_->wait(seen);
+        } else {
+            event_notifier_->wait_for(seen, std::chrono::microseconds(wait_usec));
+        }
+    }
+}
+
 bool RpcServicesClient::send_cancel_request(const std::string& service_name) {
     auto it = rpc_endpoints_.find(service_name);
     if (it == rpc_endpoints_.end()) {
@@ -143,6 +266,23 @@ bool RpcServicesClient::send_cancel_request(const std::string& service_name) {
     return it->second->send_cancel_request();
 }
 
+bool RpcServicesClient::send_cancel_request(const std::string& service_name, Hako_uint32 request_id) {
+    auto it = rpc_endpoints_.find(service_name);
+    if (it == rpc_endpoints_.end()) {
+        std::cerr << "ERROR: Service '" << service_name << "' not found for sending cancel request." << std::endl;
+        return false;
+    }
+    return it->second->send_cancel_request(request_id);
+}
+
+size_t RpcServicesClient::get_max_in_flight(const std::string& service_name) const {
+    auto it = rpc_endpoints_.find(service_name);
+    if (it == rpc_endpoints_.end()) {
+        return 0;
+    }
+    return it->second->get_max_in_flight();
+}
+
 bool RpcServicesClient::create_request_buffer(const std::string& service_name, PduData& pdu) {
     auto it = rpc_endpoints_.find(service_name);
     if (it == rpc_endpoints_.end()) {
@@ -166,6 +306,69 @@ bool RpcServicesClient::create_request_buffer(const std::string& service_name, H
     return true;
 }
 
+bool RpcServicesClient::create_request_buffer(const std::string& service_name, uint8_t* buffer, size_t capacity, size_t& out_size) {
+    out_size = 0;
+    auto it = rpc_endpoints_.find(service_name);
+    if (it == rpc_endpoints_.end()) {
+        std::cerr << "ERROR: Service '" << service_name << "' not found for creating request buffer." << std::endl;
+        return false;
+    }
+    return it->second->create_request_buffer(HAKO_SERVICE_OPERATION_CODE_REQUEST, false, buffer, capacity, out_size);
+}
+
+ServiceHandle RpcServicesClient::get_service(const std::string& service_name) const {
+    auto it = rpc_endpoints_.find(service_name);
+    if (it == rpc_endpoints_.end()) {
+        std::cerr << "ERROR: Service '" << service_name << "' not found for resolving a handle." << std::endl;
+        return ServiceHandle{};
+    }
+    return ServiceHandle{this, it->second->get_event_slot()};
+}
+
+IRpcClientEndpoint* RpcServicesClient::endpoint_of(ServiceHandle service, const char* action) const {
+    if (service.owner != this || service.slot >= endpoint_slots_.size()) {
+        std::cerr << "ERROR: Invalid service handle for " << action << "." << std::endl;
+        return nullptr;
+    }
+    return endpoint_slots_[service.slot].get();
+}
+
+bool RpcServicesClient::call(ServiceHandle service, const PduData& request_pdu, uint64_t timeout_usec) {
+    IRpcClientEndpoint* endpoint = endpoint_of(service, "RPC call");
+    return endpoint != nullptr && endpoint->call(request_pdu, timeout_usec);
+}
+
+bool RpcServicesClient::call(ServiceHandle service, const PduData& request_pdu, uint64_t timeout_usec, Hako_uint32& request_id) {
+    IRpcClientEndpoint* endpoint = endpoint_of(service, "RPC call");
+    return endpoint != nullptr && endpoint->call(request_pdu, timeout_usec, request_id);
+}
+
+bool RpcServicesClient::send_cancel_request(ServiceHandle service) {
+    IRpcClientEndpoint* endpoint = endpoint_of(service, "sending cancel request");
+    return endpoint != nullptr && endpoint->send_cancel_request();
+}
+
+bool RpcServicesClient::send_cancel_request(ServiceHandle service, Hako_uint32 request_id) {
+    IRpcClientEndpoint* endpoint = endpoint_of(service, "sending cancel request");
+    return endpoint != nullptr && endpoint->send_cancel_request(request_id);
+}
+
+bool RpcServicesClient::create_request_buffer(ServiceHandle service, PduData& pdu) {
+    IRpcClientEndpoint* endpoint = endpoint_of(service, "creating request buffer");
+    if (endpoint == nullptr) {
+        return false;
+    }
+    endpoint->create_request_buffer(HAKO_SERVICE_OPERATION_CODE_REQUEST, false, pdu);
+    return true;
+}
+
+bool RpcServicesClient::create_request_buffer(ServiceHandle service, uint8_t* buffer, size_t capacity, size_t& out_size) {
+    out_size = 0;
+    IRpcClientEndpoint* endpoint = endpoint_of(service, "creating request buffer");
+    return endpoint != nullptr
+        && endpoint->create_request_buffer(HAKO_SERVICE_OPERATION_CODE_REQUEST, false, buffer, capacity, out_size);
+}
+
 void RpcServicesClient::clear_all_instances() {
     for (auto& endpoint_pair : rpc_endpoints_) {
         auto& endpoint = endpoint_pair.second;
@@ -0,0 +1,135 @@
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+
+#include <exception>
+#include <iostream>
+
+namespace hakoniwa::pdu::rpc {
+
+std::future<RpcCallResult> RpcServicesClient::call_async(const std::string& service_name, const PduData& request_pdu, uint64_t timeout_usec) {
+    auto promise = std::make_shared<std::promise<RpcCallResult>>();
+    std::future<RpcCallResult> future = promise->get_future();
+    const bool sent = call_async(service_name, request_pdu, timeout_usec, [promise](RpcCallResult&& result) {
+        promise->set_value(std::move(result));
+    });
+    if (!sent) {
+        promise->set_value(RpcCallResult{});
+    }
+    return future;
+}
+
+bool RpcServicesClient::call_async(const std::string& service_name, const PduData& request_pdu, uint64_t timeout_usec, CallCallback callback) {
+    {
+        // Registered under the same lock as the call, so the pump cannot see
+        // the response before the callback is in place.
+        std::lock_guard<std::mutex> lock(async_mtx_);
+        Hako_uint32 request_id = 0;
+        if (!call(service_name, request_pdu, timeout_usec, request_id)) {
+            return false;
+        }
+        async_calls_[AsyncCallKey(service_name, request_id)] = std::move(callback);
+    }
+    async_cv_.notify_all();
+    return true;
+}
+
+void RpcServicesClient::complete_async_call(ClientEventType event, const std::string& service_name, RpcResponse& response, size_t& completed) {
+    const AsyncCallKey key(service_name, response.header.request_id);
+    CallCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(async_mtx_);
+        if (abandoned_calls_.erase(key) > 0) {
+            // The late response or cancel reply of a call that already timed out.
+            return;
+        }
+        auto it = async_calls_.find(key);
+        if (it == async_calls_.end()) {
+            std::cerr << "WARNING: Dropping event for request " << key.second
+                      << " of service " << service_name << ", which was not made with call_async()" << std::endl;
+            return;
+        }
+        callback = std::move(it->second);
+        async_calls_.erase(it);
+        if (event == ClientEventType::RESPONSE_TIMEOUT) {
+            if (send_cancel_request(service_name, key.second)) {
+                abandoned_calls_.insert(key);
+            } else {
+                std::cerr << "ERROR: Failed to cancel timed-out request " << key.second
+                          << " of service " << service_name << std::endl;
+            }
+        }
+    }
+    RpcCallResult result;
+    result.event = event;
+    result.response = std::move(response);
+    try {
+        callback(std::move(result));
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: call_async callback for service " << service_name << " threw: " << e.what() << std::endl;
+    }
+    ++completed;
+}
+
+size_t RpcServicesClient::run_once(uint64_t timeout_usec) {
+    size_t completed = 0;
+    bool handled = false;
+    std::string service_name;
+    RpcResponse response;
+    for (;;) {
+        const ClientEventType event = poll(service_name, response);
+        if (event == ClientEventType::NONE) {
+            break;
+        }
+        complete_async_call(event, service_name, response, completed);
+        handled = true;
+    }
+    if (!handled) {
+        const ClientEventType event = poll_wait(service_name, response, timeout_usec);
+        if (event != ClientEventType::NONE) {
+            complete_async_call(event, service_name, response, completed);
+        }
+    }
+    return completed;
+}
+
+bool RpcServicesClient::start_event_pump() {
+    std::lock_guard<std::mutex> lock(async_mtx_);
+    if (event_pump_running_) {
+        return true;
+    }
+    event_pump_running_ = true;
+    event_pump_ = std::thread(&RpcServicesClient::event_pump_loop, this);
+    return true;
+}
+
+void RpcServicesClient::stop_event_pump() {
+    {
+        std::lock_guard<std::mutex> lock(async_mtx_);
+        if (!event_pump_running_) {
+            return;
+        }
+        event_pump_running_ = false;
+    }
+    async_cv_.notify_all();
+    if (event_pump_.joinable()) {
+        event_pump_.join();
+    }
+}
+
+void RpcServicesClient::event_pump_loop() {
+    for (;;) {
+        {
+            // Sleep while no async call is outstanding; poll_wait() would
+            // return at once and turn the loop into a spin.
+            std::unique_lock<std::mutex> lock(async_mtx_);
+            async_cv_.wait(lock, [this] {
+                return !event_pump_running_ || !async_calls_.empty() || !abandoned_calls_.empty();
+            });
+            if (!event_pump_running_) {
+                return;
+            }
+        }
+        run_once(EVENT_PUMP_WAIT_USEC);
+    }
+}
+
+} // namespace hakoniwa::pdu::rpc
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <atomic>
 #include <mutex>
+#include <span>
 #include <utility>
 #include <vector>
 
@@ -111,13 +112,18 @@ public:
         accept_new_connections_();
         cleanup_disconnected_();
 
-        for (auto& slot : slots_) {
+        // Resume after the connection served last, so a busy connection
+        // cannot starve the ones accepted after it.
+        for (std::size_t i = 0; i < slots_.size(); ++i) {
+            const std::size_t index = (next_slot_ + i) % slots_.size();
+            auto& slot = slots_[index];
             if (!slot.server) {
                 continue;
             }
             RpcRequest candidate;
             const auto event = slot.server->poll(candidate);
             if (event != ServerEventType::NONE) {
+                next_slot_ = index + 1;
                 request.connection_id = slot.connection_id;
                 request.request = std::move(candidate);
                 return event;
@@ -128,6 +134,47 @@ public:
         return ServerEventType::NONE;
     }
 
+    std::size_t poll_batch(std::span<RpcMuxRequest> requests)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_ || !mux_ || requests.empty()) {
+            return 0;
+        }
+
+        accept_new_connections_();
+        cleanup_disconnected_();
+
+        // Same rotation as poll(): each connection drains into the room left,
+        // and the next call starts after the last connection served.
+        if (batch_.size() < requests.size()) {
+            batch_.resize(requests.size());
+        }
+        std::size_t count = 0;
+        const std::size_t slot_count = slots_.size();
+        for (std::size_t i = 0; i < slot_count && count < requests.size(); ++i) {
+            const std::size_t index = (next_slot_ + i) % slot_count;
+            auto& slot = slots_[index];
+            if (!slot.server) {
+                continue;
+            }
+            const std::size_t taken = slot.server->poll_batch(
+                std::span<RpcRequest>(batch_.data(), requests.size() - count));
+            for (std::size_t j = 0; j < taken; ++j) {
+                requests[count + j].connection_id = slot.connection_id;
+                requests[count + j].request = std::move(batch_[j]);
+            }
+            if (taken > 0) {
+                next_slot_ = index + 1;
+                count += taken;
+            }
+        }
+
+        if (count == 0) {
+            cleanup_disconnected_();
+        }
+        return count;
+    }
+
     bool create_reply_buffer(
         const RpcMuxRequest& request,
         Hako_uint8 status,
@@ -277,6 +324,9 @@ private:
     mutable std::mutex mutex_;
     std::unique_ptr<hakoniwa::pdu::EndpointCommMultiplexer> mux_;
     std::vector<ConnectionSlot> slots_;
+    std::size_t next_slot_{0};
+    // Reused by poll_batch() to collect one connection's requests.
+    std::vector<RpcRequest> batch_;
     std::uint64_t next_connection_id_{1};
     bool started_{false};
 };
@@ -320,6 +370,11 @@ ServerEventType RpcServicesMuxServer::poll(RpcMuxRequest& request)
     return impl_->poll(request);
 }
 
+std::size_t RpcServicesMuxServer::poll_batch(std::span<RpcMuxRequest> requests)
+{
+    return impl_->poll_batch(requests);
+}
+
 bool RpcServicesMuxServer::create_reply_buffer(
     const RpcMuxRequest& request,
     Hako_uint8 status,
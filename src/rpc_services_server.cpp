@@ -12,6 +12,8 @@
 #include <map>
 #include <memory>
 #include <filesystem>
+#include <algorithm>
+#include <chrono>
 
 namespace hakoniwa::pdu::rpc {
 
@@ -35,6 +37,30 @@ bool RpcServicesServer::initialize_services(
         nullptr, std::move(endpoint), std::move(client_node_id));
 }
 
+namespace {
+
+RpcServicesServer::ServiceConfig read_service_config(const nlohmann::json& service_entry)
+{
+    RpcServicesServer::ServiceConfig config;
+    config.type = service_entry["type"];
+    config.max_clients = service_entry["maxClients"].get<uint32_t>();
+    const auto& pdu_size = service_entry["pduSize"];
+    config.server_base_size = pdu_size["server"]["baseSize"].get<size_t>();
+    config.server_heap_size = pdu_size["server"]["heapSize"].get<size_t>();
+    config.client_base_size = pdu_size["client"]["baseSize"].get<size_t>();
+    config.client_heap_size = pdu_size["client"]["heapSize"].get<size_t>();
+    config.dynamic_client = service_entry.value("dynamicClient", false);
+    if (!config.dynamic_client && service_entry.contains("clients")) {
+        for (const auto& client : service_entry["clients"]) {
+            config.clients.push_back(RpcServicesServer::ServiceConfig::Client{
+                client["name"], client["requestChannelId"], client["responseChannelId"]});
+        }
+    }
+    return config;
+}
+
+} // namespace
+
 bool RpcServicesServer::initialize_services_impl(
     std::shared_ptr<hakoniwa::pdu::EndpointContainer> endpoint_container,
     std::shared_ptr<hakoniwa::pdu::Endpoint> endpoint_override,
@@ -108,6 +134,14 @@ bool RpcServicesServer::initialize_services_impl(
                 }
             }
 
+            const uint32_t weight = service_entry.value("weight", DEFAULT_SERVICE_WEIGHT);
+            if (weight == 0) {
+                std::cerr << "ERROR: 'weight' must be greater than 0 for service " << service_name << std::endl;
+                std::cout.flush();
+                stop_all_services();
+                return false;
+            }
+
             std::shared_ptr<IRpcServerEndpoint> rpc_server_endpoint;
             if (impl_type_ == "RpcServerEndpointImpl") {
                 rpc_server_endpoint = std::make_shared<RpcServerEndpointImpl>(
@@ -118,6 +152,11 @@ bool RpcServicesServer::initialize_services_impl(
                 stop_all_services();
                 return false;
             }
+            // A re-initialized service keeps the slot of the endpoint it replaces.
+            auto existing = rpc_endpoints_.find(service_name);
+            const size_t slot = existing != rpc_endpoints_.end()
+                ? existing->second->get_event_slot() : endpoint_slots_.size();
+            rpc_server_endpoint->set_event_notifier(event_notifier_, slot);
             if (!rpc_server_endpoint->initialize(service_entry, pdu_meta_data_size, client_node_id)) {
                 std::cerr << "ERROR: Failed to initialize RPC server endpoint for service " << service_name << std::endl;
                 std::cout.flush();
@@ -126,6 +165,12 @@ bool RpcServicesServer::initialize_services_impl(
             }
 
             rpc_endpoints_[service_name] = rpc_server_endpoint;
+            ServiceSlot service_slot{rpc_server_endpoint, weight, read_service_config(service_entry)};
+            if (slot == endpoint_slots_.size()) {
+                endpoint_slots_.push_back(std::move(service_slot));
+            } else {
+                endpoint_slots_[slot] = std::move(service_slot);
+            }
             std::cout << "INFO: Successfully initialized service: " << service_name
                       << " on node " << node_id_ << std::endl;
             std::cout.flush();
@@ -149,16 +194,112 @@ void RpcServicesServer::stop_all_services() {
     }
 }
 
+namespace {
+
+ServerEventType request_event(const RpcRequest& request)
+{
+    return request.header.opcode == HAKO_SERVICE_OPERATION_CODE_CANCEL
+        ? ServerEventType::REQUEST_CANCEL : ServerEventType::REQUEST_IN;
+}
+
+} // namespace
+
 ServerEventType RpcServicesServer::poll(RpcRequest& request)
 {
-    for (auto& endpoint_pair : rpc_endpoints_) {
-        auto& endpoint = endpoint_pair.second;
-        ServerEventType event = endpoint->poll(request);
-        if (event != ServerEventType::NONE) {
-            return event;
+    if (poll_batch_slots(std::span<RpcRequest>(&request, 1), nullptr) == 0) {
+        return ServerEventType::NONE;
+    }
+    return request_event(request);
+}
+
+ServerEventType RpcServicesServer::poll(ServiceHandle& service, RpcRequest& request)
+{
+    size_t slot = 0;
+    if (poll_batch_slots(std::span<RpcRequest>(&request, 1), &slot) == 0) {
+        return ServerEventType::NONE;
+    }
+    service = ServiceHandle{this, slot};
+    return request_event(request);
+}
+
+size_t RpcServicesServer::poll_batch(std::span<RpcRequest> requests)
+{
+    return poll_batch_slots(requests, nullptr);
+}
+
+size_t RpcServicesServer::poll_batch_slots(std::span<RpcRequest> requests, size_t* slots)
+{
+    // Only endpoints with queued requests are listed, so an idle poll takes
+    // one lock instead of one per service. Listing is FIFO, which makes the
+    // turns round-robin; an endpoint with work left re-lists itself at the
+    // tail. A turn is up to `weight` requests, taken under one endpoint lock.
+    size_t count = 0;
+    while (count < requests.size()) {
+        size_t slot = 0;
+        uint32_t quota = 0;
+        if (burst_left_ > 0) {
+            // Finish the turn a previous call ran out of room for.
+            slot = burst_slot_;
+            quota = burst_left_;
+            burst_left_ = 0;
+        } else if (event_notifier_->pop_ready(slot)) {
+            if (slot >= endpoint_slots_.size()) {
+                continue; // from an endpoint that failed to initialize
+            }
+            quota = endpoint_slots_[slot].weight;
+        } else {
+            break;
+        }
+        const size_t wanted = std::min<size_t>(quota, requests.size() - count);
+        const size_t taken = endpoint_slots_[slot].endpoint->poll_batch(requests.subspan(count, wanted));
+        if (slots != nullptr) {
+            std::fill(slots + count, slots + count + taken, slot);
+        }
+        count += taken;
+        if (taken == wanted && wanted < quota) {
+            burst_slot_ = slot;
+            burst_left_ = quota - static_cast<uint32_t>(wanted);
+        }
+    }
+    return count;
+}
+
+ServerEventType RpcServicesServer::poll_wait(RpcRequest& request, uint64_t timeout_usec)
+{
+    size_t slot = 0;
+    return poll_wait_slot(slot, request, timeout_usec);
+}
+
+ServerEventType RpcServicesServer::poll_wait(ServiceHandle& service, RpcRequest& request, uint64_t timeout_usec)
+{
+    size_t slot = 0;
+    ServerEventType event = poll_wait_slot(slot, request, timeout_usec);
+    if (event != ServerEventType::NONE) {
+        service = ServiceHandle{this, slot};
+    }
+    return event;
+}
+
+ServerEventType RpcServicesServer::poll_wait_slot(size_t& slot, RpcRequest& request, uint64_t timeout_usec)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_usec);
+    while (true) {
+        // Read the sequence before polling so a request queued in between
+        // still ends the wait.
+        const uint64_t seen = event_notifier_->sequence();
+        if (poll_batch_slots(std::span<RpcRequest>(&request, 1), &slot) > 0) {
+            return request_event(request);
+        }
+        if (timeout_usec == 0) {
+            event_notifier_->wait(seen);
+            continue;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return ServerEventType::NONE;
         }
+        event_notifier_->wait_for(seen, std::chrono::duration_cast<std::chrono::microseconds>(deadline - now));
     }
-    return ServerEventType::NONE;
 }
 
 void RpcServicesServer::clear_all_instances() {
@@ -0,0 +1,219 @@
+#include "hakoniwa/pdu/rpc/rpc_timer_wheel.hpp"
+
+namespace hakoniwa::pdu::rpc {
+
+RpcTimerWheel::RpcTimerWheel(uint64_t tick_usec)
+    : tick_usec_(tick_usec == 0 ? 1 : tick_usec)
+{
+    slots_.fill(NIL);
+}
+
+RpcTimerWheel::TimerId RpcTimerWheel::schedule(uint64_t now_usec, uint64_t deadline_usec, size_t owner, uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    const uint64_t now_tick = now_usec / tick_usec_;
+    if (!started_ || (size_ == 0 && now_tick > current_tick_)) {
+        // Nothing to catch up on, so the wheel can start from now.
+        current_tick_ = now_tick;
+        started_ = true;
+    }
+    uint32_t index;
+    if (!free_.empty()) {
+        index = free_.back();
+        free_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node& node = nodes_[index];
+    node.deadline_tick = to_tick_ceil(deadline_usec);
+    node.owner = owner;
+    node.id = id;
+    place(index);
+    ++size_;
+    return (static_cast<TimerId>(node.generation) << 32) | (static_cast<TimerId>(index) + 1);
+}
+
+void RpcTimerWheel::cancel(TimerId timer)
+{
+    if (timer == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    const uint64_t index = (timer & UINT32_MAX) - 1;
+    if (index >= nodes_.size()) {
+        return;
+    }
+    const Node& node = nodes_[index];
+    // A timer that fired or was cancelled already has moved on a generation.
+    if (node.slot == NIL || node.generation != static_cast<uint32_t>(timer >> 32)) {
+        return;
+    }
+    unlink(static_cast<uint32_t>(index));
+    release(static_cast<uint32_t>(index));
+}
+
+void RpcTimerWheel::advance(uint64_t now_usec, std::vector<Expired>& expired)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    const uint64_t now_tick = now_usec / tick_usec_;
+    if (!started_) {
+        current_tick_ = now_tick;
+        started_ = true;
+    }
+    while (current_tick_ < now_tick) {
+        if (size_ == 0) {
+            current_tick_ = now_tick;
+            break;
+        }
+        const uint64_t last_idle_tick = current_tick_ | idle_mask();
+        if (last_idle_tick >= now_tick) {
+            current_tick_ = now_tick;
+            break;
+        }
+        current_tick_ = last_idle_tick + 1;
+        if ((current_tick_ & SLOT_MASK) == 0) {
+            spread(1);
+        }
+        fire_slot(static_cast<uint32_t>(current_tick_ & SLOT_MASK), expired);
+    }
+    // Scheduled already due, or spread onto the current tick.
+    fire_slot(DUE_SLOT, expired);
+}
+
+uint64_t RpcTimerWheel::usec_until_next(uint64_t now_usec) const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (slots_[DUE_SLOT] != NIL) {
+        return 0;
+    }
+    if (size_ == 0) {
+        return UINT64_MAX;
+    }
+    uint64_t next_tick = (current_tick_ | idle_mask()) + 1;
+    if (level_size_[0] > 0) {
+        // The first occupied level-0 slot, or the wrap, whichever is first.
+        for (uint64_t tick = current_tick_ + 1; (tick & SLOT_MASK) != 0; ++tick) {
+            if (slots_[tick & SLOT_MASK] != NIL) {
+                next_tick = tick;
+                break;
+            }
+        }
+    }
+    const uint64_t next_usec = next_tick * tick_usec_;
+    return next_usec > now_usec ? next_usec - now_usec : 0;
+}
+
+size_t RpcTimerWheel::size() const
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    return size_;
+}
+
+void RpcTimerWheel::place(uint32_t index)
+{
+    const uint64_t deadline_tick = nodes_[index].deadline_tick;
+    if (deadline_tick <= current_tick_) {
+        link(index, DUE_SLOT);
+        return;
+    }
+    const uint64_t delta = deadline_tick - current_tick_;
+    size_t level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t{1} << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    uint64_t target_tick = deadline_tick;
+    if (delta >= (uint64_t{1} << (SLOT_BITS * LEVELS))) {
+        // Beyond the span: park in the last slot within it; it is placed
+        // again when that slot is spread.
+        target_tick = current_tick_ + (uint64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+    }
+    const uint64_t slot_index = (target_tick >> (SLOT_BITS * level)) & SLOT_MASK;
+    link(index, static_cast<uint32_t>(level * SLOTS + slot_index));
+}
+
+void RpcTimerWheel::link(uint32_t index, uint32_t slot)
+{
+    Node& node = nodes_[index];
+    node.slot = slot;
+    node.prev = NIL;
+    node.next = slots_[slot];
+    if (node.next != NIL) {
+        nodes_[node.next].prev = index;
+    }
+    slots_[slot] = index;
+    if (slot != DUE_SLOT) {
+        ++level_size_[slot / SLOTS];
+    }
+}
+
+void RpcTimerWheel::unlink(uint32_t index)
+{
+    Node& node = nodes_[index];
+    if (node.prev != NIL) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        slots_[node.slot] = node.next;
+    }
+    if (node.next != NIL) {
+        nodes_[node.next].prev = node.prev;
+    }
+    if (node.slot != DUE_SLOT) {
+        --level_size_[node.slot / SLOTS];
+    }
+    node.prev = NIL;
+    node.next = NIL;
+}
+
+void RpcTimerWheel::release(uint32_t index)
+{
+    Node& node = nodes_[index];
+    node.slot = NIL;
+    ++node.generation;
+    free_.push_back(index);
+    --size_;
+}
+
+void RpcTimerWheel::spread(size_t level)
+{
+    const uint64_t slot_index = (current_tick_ >> (SLOT_BITS * level)) & SLOT_MASK;
+    if (slot_index == 0 && level + 1 < LEVELS) {
+        spread(level + 1);
+    }
+    const uint32_t slot = static_cast<uint32_t>(level * SLOTS + slot_index);
+    uint32_t index = slots_[slot];
+    while (index != NIL) {
+        const uint32_t next = nodes_[index].next;
+        unlink(index);
+        place(index);
+        index = next;
+    }
+}
+
+void RpcTimerWheel::fire_slot(uint32_t slot, std::vector<Expired>& expired)
+{
+    uint32_t index = slots_[slot];
+    while (index != NIL) {
+        const uint32_t next = nodes_[index].next;
+        unlink(index);
+        Node& node = nodes_[index];
+        if (node.deadline_tick <= current_tick_) {
+            expired.push_back(Expired{node.owner, node.id});
+            release(index);
+        } else {
+            place(index);
+        }
+        index = next;
+    }
+}
+
+uint64_t RpcTimerWheel::idle_mask() const
+{
+    size_t empty_levels = 0;
+    while (empty_levels + 1 < LEVELS && level_size_[empty_levels] == 0) {
+        ++empty_levels;
+    }
+    return (uint64_t{1} << (SLOT_BITS * empty_levels)) - 1;
+}
+
+} // namespace hakoniwa::pdu::rpc
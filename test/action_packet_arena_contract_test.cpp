@@ -0,0 +1,78 @@
+#include "action_packet_arena.hpp"
+
+#include <gtest/gtest.h>
+
+#include "pdu_primitive_ctypes.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+using hakoniwa::pdu::action::ActionPacketArena;
+using hakoniwa::pdu::action::PduData;
+
+constexpr std::uint32_t kBaseSize = 64;
+constexpr std::size_t kHeapCapacity = 256;
+
+TEST(ActionPacketArenaContractTest, CopiesAValidEmptyPacket)
+{
+    ActionPacketArena arena;
+    PduData packet;
+    ASSERT_TRUE(arena.copy_empty_packet(kBaseSize, kHeapCapacity, packet));
+    ASSERT_GE(packet.size(), sizeof(HakoPduMetaDataType));
+    HakoPduMetaDataType metadata{};
+    std::memcpy(&metadata, packet.data(), sizeof(metadata));
+    EXPECT_FALSE(HAKO_PDU_METADATA_IS_INVALID(&metadata));
+    EXPECT_EQ(static_cast<std::size_t>(metadata.total_size), packet.size());
+    EXPECT_GE(metadata.heap_off, metadata.base_off + static_cast<std::int32_t>(kBaseSize));
+
+    PduData control;
+    ASSERT_TRUE(arena.copy_empty_packet(kBaseSize, 0, control));
+    EXPECT_LT(control.size(), packet.size());
+}
+
+TEST(ActionPacketArenaContractTest, ReusedBufferIsOverwrittenWithoutReallocation)
+{
+    ActionPacketArena arena;
+    PduData packet;
+    ASSERT_TRUE(arena.copy_empty_packet(kBaseSize, kHeapCapacity, packet));
+    const PduData empty = packet;
+    const auto* storage = packet.data();
+
+    std::memset(packet.data() + sizeof(HakoPduMetaDataType), 0x5a, packet.size() - sizeof(HakoPduMetaDataType));
+    ASSERT_TRUE(arena.copy_empty_packet(kBaseSize, kHeapCapacity, packet));
+    EXPECT_EQ(packet, empty);
+    EXPECT_EQ(packet.data(), storage);
+}
+
+TEST(ActionPacketArenaContractTest, ScratchBelongsToItsArena)
+{
+    ActionPacketArena arena;
+    ActionPacketArena other;
+    PduData* scratch = nullptr;
+    {
+        const auto lock = arena.lock_scratch();
+        scratch = &arena.scratch();
+        ASSERT_TRUE(arena.copy_empty_packet(kBaseSize, kHeapCapacity, *scratch));
+    }
+    std::thread([&arena, scratch] {
+        const auto lock = arena.lock_scratch();
+        EXPECT_EQ(&arena.scratch(), scratch);
+    }).join();
+    const auto lock = other.lock_scratch();
+    EXPECT_NE(&other.scratch(), scratch);
+}
+
+TEST(ActionPacketArenaContractTest, DynamicMemoryIsEmptyOnEachUse)
+{
+    ActionPacketArena arena;
+    const auto lock = arena.lock_scratch();
+    PduDynamicMemory& memory = arena.dynamic_memory();
+    ASSERT_NE(memory.allocate(32), nullptr);
+    EXPECT_GT(memory.get_total_size(), 0U);
+    EXPECT_EQ(arena.dynamic_memory().get_total_size(), 0U);
+}
+
+} // namespace
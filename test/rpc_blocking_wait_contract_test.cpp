@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcResponse;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa_rpc_test::RpcRuntime;
+
+constexpr const char* kConfigPath = "configs/service_config.json";
+constexpr const char* kServiceName = "Service/Add";
+// Generous bound on how late a waiter may wake, for loaded CI machines.
+constexpr auto kWakeSlack = 500ms;
+
+bool send_add(RpcRuntime& runtime, long long a, long long b, uint64_t timeout_usec)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = a;
+    request_body.b = b;
+    hakoniwa::pdu::rpc::PduData request_pdu;
+    if (!service.set_request_body(runtime.client(), kServiceName, request_body, request_pdu)) {
+        return false;
+    }
+    return runtime.client().call(kServiceName, request_pdu, timeout_usec);
+}
+
+bool reply_add(RpcRuntime& runtime, RpcRequest& request)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest parsed_request{};
+    if (!service.get_request_body(request, parsed_request)) {
+        return false;
+    }
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = parsed_request.a + parsed_request.b;
+    return service.reply(
+        runtime.server(),
+        request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+        response_body);
+}
+
+TEST(RpcBlockingWaitContractTest, ServerWaitReturnsNoneAtItsDeadline)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    RpcRequest request;
+    const auto started = std::chrono::steady_clock::now();
+    EXPECT_EQ(runtime.server().poll_wait(request, 50'000), ServerEventType::NONE);
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    EXPECT_GE(elapsed, 50ms);
+    EXPECT_LT(elapsed, 50ms + kWakeSlack);
+}
+
+TEST(RpcBlockingWaitContractTest, ClientWaitWithoutCallsReturnsImmediately)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    std::string service_name;
+    RpcResponse response;
+    const auto started = std::chrono::steady_clock::now();
+    // Even with no timeout: nothing is in flight, so nothing can arrive.
+    EXPECT_EQ(runtime.client().poll_wait(service_name, response, 0), ClientEventType::NONE);
+    EXPECT_LT(std::chrono::steady_clock::now() - started, kWakeSlack);
+}
+
+TEST(RpcBlockingWaitContractTest, RequestAndResponseWakeTheWaiters)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    std::thread server_thread([&runtime] {
+        RpcRequest request;
+        if (runtime.server().poll_wait(request, 2'000'000) == ServerEventType::REQUEST_IN) {
+            reply_add(runtime, request);
+        }
+    });
+    // Let the server block before the request is sent.
+    std::this_thread::sleep_for(20ms);
+    ASSERT_TRUE(send_add(runtime, 2, 3, 2'000'000));
+
+    std::string service_name;
+    RpcResponse response;
+    const auto started = std::chrono::steady_clock::now();
+    const auto event = runtime.client().poll_wait(service_name, response, 2'000'000);
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    server_thread.join();
+
+    ASSERT_EQ(event, ClientEventType::RESPONSE_IN);
+    EXPECT_EQ(service_name, kServiceName);
+    EXPECT_LT(elapsed, kWakeSlack);
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsResponse body{};
+    ASSERT_TRUE(service.get_response_body(response, body));
+    EXPECT_EQ(body.sum, 5);
+}
+
+TEST(RpcBlockingWaitContractTest, ClientWaitWakesWhenACallTimesOut)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    // The server never answers, so only the call's own deadline can end the
+    // wait; the wait itself has no timeout.
+    ASSERT_TRUE(send_add(runtime, 1, 1, 100'000));
+    std::string service_name;
+    RpcResponse response;
+    const auto started = std::chrono::steady_clock::now();
+    EXPECT_EQ(runtime.client().poll_wait(service_name, response, 0), ClientEventType::RESPONSE_TIMEOUT);
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    EXPECT_GE(elapsed, 100ms);
+    EXPECT_LT(elapsed, 100ms + kWakeSlack);
+}
+
+} // namespace
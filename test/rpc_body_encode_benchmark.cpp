@@ -0,0 +1,127 @@
+// Compares the typed body encoders of HakoRpcAssetServiceServer: the
+// round-trip path, which decodes the whole packet and encodes it again, and
+// the in-place path of HakoRpcServiceServerTemplateType, which serializes
+// only the body into the buffer the endpoint created.
+//
+// Usage: hakoniwa_pdu_rpc_body_encode_benchmark
+#include "hakoniwa/pdu/endpoint_container.hpp"
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace {
+
+using hakoniwa::pdu::rpc::PduData;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+
+constexpr const char* kConfigPath = RPC_BENCHMARK_SERVICE_CONFIG_PATH;
+constexpr const char* kEndpointConfigPath = RPC_BENCHMARK_ENDPOINTS_CONFIG_PATH;
+constexpr const char* kServerNodeId = "server_node";
+constexpr const char* kClientNodeId = "client_node";
+constexpr const char* kClientName = "TestClient";
+constexpr const char* kServiceName = "Service/Add";
+constexpr int kIterations = 200000;
+
+// The helper as instantiated before in-place encoding: no C packet types.
+using RoundTripService = hakoniwa::pdu::rpc::HakoRpcAssetServiceServer<
+    HakoCpp_AddTwoIntsRequestPacket,
+    HakoCpp_AddTwoIntsResponsePacket,
+    HakoCpp_AddTwoIntsRequest,
+    HakoCpp_AddTwoIntsResponse,
+    HAKO_RPC_SERVICE_SERVER_TYPE(AddTwoIntsRequestPacket),
+    HAKO_RPC_SERVICE_SERVER_TYPE(AddTwoIntsResponsePacket)>;
+using InPlaceService = HakoRpcServiceServerTemplateType(AddTwoInts);
+
+// Nanoseconds per call of encode, or a negative value on failure.
+template <typename Encode>
+double measure(Encode encode)
+{
+    const auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        if (!encode(i)) {
+            return -1.0;
+        }
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count();
+    return elapsed / kIterations;
+}
+
+template <typename Service>
+double measure_request(RpcServicesClient& client)
+{
+    Service service;
+    HakoCpp_AddTwoIntsRequest body{};
+    PduData pdu;
+    return measure([&](int i) {
+        body.a = i;
+        body.b = i + 1;
+        return service.set_request_body(client, kServiceName, body, pdu);
+    });
+}
+
+template <typename Service>
+double measure_response(RpcServicesServer& server, RpcRequest& request)
+{
+    Service service;
+    HakoCpp_AddTwoIntsResponse body{};
+    PduData pdu;
+    return measure([&](int i) {
+        body.sum = i;
+        return service.set_response_body(server, request,
+            hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+            hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+            body, pdu);
+    });
+}
+
+} // namespace
+
+int main()
+{
+    auto server_container = std::make_shared<hakoniwa::pdu::EndpointContainer>(kServerNodeId, kEndpointConfigPath);
+    auto client_container = std::make_shared<hakoniwa::pdu::EndpointContainer>(kClientNodeId, kEndpointConfigPath);
+    if (server_container->initialize() != HAKO_PDU_ERR_OK || client_container->initialize() != HAKO_PDU_ERR_OK) {
+        std::fprintf(stderr, "ERROR: failed to initialize endpoints\n");
+        return 1;
+    }
+    RpcServicesServer server(kServerNodeId, "RpcServerEndpointImpl", kConfigPath, 1000);
+    RpcServicesClient client(kClientNodeId, kClientName, kConfigPath, "RpcClientEndpointImpl", 1000);
+    if (!server.initialize_services(server_container) || !client.initialize_services(client_container)) {
+        std::fprintf(stderr, "ERROR: failed to initialize services\n");
+        return 1;
+    }
+
+    // Replies only need the header of the request they answer.
+    RpcRequest request;
+    request.client_name = kClientName;
+    request.header.request_id = 1;
+    request.header.service_name = kServiceName;
+    request.header.client_name = kClientName;
+    request.header.opcode = hakoniwa::pdu::rpc::HAKO_SERVICE_OPERATION_CODE_REQUEST;
+
+    const double request_round_trip = measure_request<RoundTripService>(client);
+    const double request_in_place = measure_request<InPlaceService>(client);
+    const double response_round_trip = measure_response<RoundTripService>(server, request);
+    const double response_in_place = measure_response<InPlaceService>(server, request);
+
+    server.clear_all_instances();
+    client.clear_all_instances();
+    if (request_round_trip < 0.0 || request_in_place < 0.0 || response_round_trip < 0.0 || response_in_place < 0.0) {
+        std::fprintf(stderr, "ERROR: encoding failed\n");
+        return 1;
+    }
+    std::printf("iterations=%d\n", kIterations);
+    std::printf("%-10s %16s %16s\n", "body", "round-trip ns", "in-place ns");
+    std::printf("%-10s %16.1f %16.1f\n", "request", request_round_trip, request_in_place);
+    std::printf("%-10s %16.1f %16.1f\n", "response", response_round_trip, response_in_place);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_service_executor.hpp"
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::PduData;
+using hakoniwa::pdu::rpc::RpcCallResult;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcServiceExecutor;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa_rpc_test::RpcRuntime;
+
+// Service/Add with maxInFlight 4.
+constexpr const char* kPipelinedConfigPath = "configs/service_config_pipelined.json";
+
+PduData make_add_request(RpcServicesClient& client, long long a, long long b)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = a;
+    request_body.b = b;
+    PduData pdu;
+    service.set_request_body(client, "Service/Add", request_body, pdu);
+    return pdu;
+}
+
+void reply_add(RpcServicesServer& server, RpcRequest& request)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest body{};
+    service.get_request_body(request, body);
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = body.a + body.b;
+    service.reply(server, request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+        response_body);
+}
+
+long long response_sum(RpcCallResult& result)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsResponse response_body{};
+    if (!service.get_response_body(result.response, response_body)) {
+        return -1;
+    }
+    return response_body.sum;
+}
+
+TEST(RpcCallAsyncContractTest, ThreadsShareOneClientThroughTheEventPump)
+{
+    RpcRuntime runtime(kPipelinedConfigPath);
+    ASSERT_TRUE(runtime.start());
+    RpcServiceExecutor executor(runtime.server(), 1);
+    ASSERT_TRUE(executor.register_handler("Service/Add", reply_add));
+    ASSERT_TRUE(executor.start());
+    ASSERT_TRUE(runtime.client().start_event_pump());
+
+    // One call per thread, within the window of 4; none of them polls.
+    constexpr int kThreads = 4;
+    std::vector<long long> sums(kThreads, -1);
+    std::vector<std::thread> callers;
+    for (int t = 0; t < kThreads; ++t) {
+        callers.emplace_back([&runtime, &sums, t] {
+            auto future = runtime.client().call_async(
+                "Service/Add", make_add_request(runtime.client(), t, 10), 2'000'000);
+            if (future.wait_for(2s) != std::future_status::ready) {
+                return;
+            }
+            RpcCallResult result = future.get();
+            if (result.event == ClientEventType::RESPONSE_IN) {
+                sums[t] = response_sum(result);
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    runtime.client().stop_event_pump();
+    executor.stop();
+
+    for (int t = 0; t < kThreads; ++t) {
+        EXPECT_EQ(sums[t], t + 10) << "thread " << t;
+    }
+}
+
+TEST(RpcCallAsyncContractTest, CallbackRunsFromRunOnce)
+{
+    RpcRuntime runtime(kPipelinedConfigPath);
+    ASSERT_TRUE(runtime.start());
+    RpcServiceExecutor executor(runtime.server(), 1);
+    ASSERT_TRUE(executor.register_handler("Service/Add", reply_add));
+    ASSERT_TRUE(executor.start());
+
+    long long sum = -1;
+    bool done = false;
+    ASSERT_TRUE(runtime.client().call_async("Service/Add", make_add_request(runtime.client(), 3, 4), 2'000'000,
+        [&](RpcCallResult&& result) {
+            EXPECT_EQ(result.event, ClientEventType::RESPONSE_IN);
+            sum = response_sum(result);
+            done = true;
+        }));
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (!done && std::chrono::steady_clock::now() < deadline) {
+        runtime.client().run_once(100'000);
+    }
+    executor.stop();
+    EXPECT_TRUE(done);
+    EXPECT_EQ(sum, 7);
+}
+
+TEST(RpcCallAsyncContractTest, UnansweredCallCompletesWithTimeout)
+{
+    RpcRuntime runtime(kPipelinedConfigPath);
+    ASSERT_TRUE(runtime.start());
+    ASSERT_TRUE(runtime.client().start_event_pump());
+
+    // Nobody serves the request.
+    auto future = runtime.client().call_async("Service/Add", make_add_request(runtime.client(), 1, 2), 50'000);
+    ASSERT_EQ(future.wait_for(1s), std::future_status::ready);
+    EXPECT_EQ(future.get().event, ClientEventType::RESPONSE_TIMEOUT);
+    runtime.client().stop_event_pump();
+}
+
+TEST(RpcCallAsyncContractTest, CallThatCannotBeSentCompletesAtOnce)
+{
+    RpcRuntime runtime(kPipelinedConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    auto future = runtime.client().call_async("Service/Unknown", PduData{}, 50'000);
+    ASSERT_EQ(future.wait_for(0s), std::future_status::ready);
+    EXPECT_EQ(future.get().event, ClientEventType::NONE);
+    bool invoked = false;
+    EXPECT_FALSE(runtime.client().call_async("Service/Unknown", PduData{}, 50'000,
+        [&](RpcCallResult&&) { invoked = true; }));
+    EXPECT_FALSE(invoked);
+}
+
+} // namespace
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_call_scheduler.hpp"
+#include "hakoniwa/pdu/rpc/rpc_service_executor.hpp"
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::PduData;
+using hakoniwa::pdu::rpc::RpcCallResult;
+using hakoniwa::pdu::rpc::RpcCallScheduler;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcServiceExecutor;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa::pdu::rpc::RpcTask;
+using hakoniwa_rpc_test::RpcRuntime;
+
+// Service/Add with maxInFlight 4.
+constexpr const char* kPipelinedConfigPath = "configs/service_config_pipelined.json";
+// Service/Add with the default window of one call.
+constexpr const char* kSingleCallConfigPath = "configs/service_config.json";
+
+PduData make_add_request(RpcServicesClient& client, long long a, long long b)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = a;
+    request_body.b = b;
+    PduData pdu;
+    service.set_request_body(client, "Service/Add", request_body, pdu);
+    return pdu;
+}
+
+void reply_add(RpcServicesServer& server, RpcRequest& request)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest body{};
+    service.get_request_body(request, body);
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = body.a + body.b;
+    service.reply(server, request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+        response_body);
+}
+
+// Makes `calls` calls one after another and records each sum.
+RpcTask add_in_sequence(RpcCallScheduler& scheduler, RpcServicesClient& client, long long base, int calls, std::vector<long long>& sums)
+{
+    for (int i = 0; i < calls; ++i) {
+        RpcCallResult result = co_await scheduler.async_call(
+            "Service/Add", make_add_request(client, base, i), 2'000'000);
+        if (result.event != ClientEventType::RESPONSE_IN) {
+            sums.push_back(-1);
+            continue;
+        }
+        HakoRpcServiceServerTemplateType(AddTwoInts) service;
+        HakoCpp_AddTwoIntsResponse response_body{};
+        service.get_response_body(result.response, response_body);
+        sums.push_back(response_body.sum);
+    }
+}
+
+RpcTask record_event(RpcCallScheduler& scheduler, std::string service_name, PduData request, uint64_t timeout_usec, ClientEventType& event)
+{
+    RpcCallResult result = co_await scheduler.async_call(service_name, std::move(request), timeout_usec);
+    event = result.event;
+}
+
+TEST(RpcCallSchedulerContractTest, ManyCoroutinesShareOneThreadAndTheServiceWindow)
+{
+    RpcRuntime runtime(kPipelinedConfigPath);
+    ASSERT_TRUE(runtime.start());
+    RpcServiceExecutor executor(runtime.server(), 1);
+    ASSERT_TRUE(executor.register_handler("Service/Add", reply_add));
+    ASSERT_TRUE(executor.start());
+
+    // Far more coroutines than the window of 4 calls.
+    constexpr int kTasks = 64;
+    constexpr int kCallsPerTask = 2;
+    RpcCallScheduler scheduler(runtime.client());
+    std::vector<std::vector<long long>> sums(kTasks);
+    for (int t = 0; t < kTasks; ++t) {
+        scheduler.spawn(add_in_sequence(scheduler, runtime.client(), t * 100, kCallsPerTask, sums[t]));
+    }
+    EXPECT_EQ(scheduler.task_count(), static_cast<size_t>(kTasks));
+    EXPECT_TRUE(scheduler.run());
+    executor.stop();
+
+    EXPECT_EQ(scheduler.task_count(), 0U);
+    for (int t = 0; t < kTasks; ++t) {
+        EXPECT_EQ(sums[t], (std::vector<long long>{t * 100, t * 100 + 1})) << "task " << t;
+    }
+}
+
+TEST(RpcCallSchedulerContractTest, UnansweredCallResumesWithTimeout)
+{
+    RpcRuntime runtime(kPipelinedConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    // Nobody serves the request.
+    RpcCallScheduler scheduler(runtime.client());
+    ClientEventType event = ClientEventType::NONE;
+    scheduler.spawn(record_event(scheduler, "Service/Add", make_add_request(runtime.client(), 1, 2), 50'000, event));
+    const auto started = std::chrono::steady_clock::now();
+    EXPECT_TRUE(scheduler.run());
+    EXPECT_EQ(event, ClientEventType::RESPONSE_TIMEOUT);
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 1s);
+}
+
+TEST(RpcCallSchedulerContractTest, CallThatCannotBeSentResumesAtOnce)
+{
+    RpcRuntime runtime(kPipelinedConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    RpcCallScheduler scheduler(runtime.client());
+    ClientEventType event = ClientEventType::RESPONSE_IN;
+    scheduler.spawn(record_event(scheduler, "Service/Unknown", PduData{}, 50'000, event));
+    EXPECT_EQ(scheduler.run_once(0), 1U);
+    EXPECT_EQ(scheduler.task_count(), 0U);
+    EXPECT_EQ(event, ClientEventType::NONE);
+}
+
+TEST(RpcCallSchedulerContractTest, TimedOutCallWhoseCancelFailsFreesItsSlot)
+{
+    RpcRuntime runtime(kSingleCallConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    RpcCallScheduler scheduler(runtime.client());
+    ClientEventType first = ClientEventType::NONE;
+    ClientEventType parked = ClientEventType::RESPONSE_IN;
+    scheduler.spawn(record_event(scheduler, "Service/Add", make_add_request(runtime.client(), 1, 2), 20'000, first));
+    scheduler.spawn(record_event(scheduler, "Service/Add", make_add_request(runtime.client(), 3, 4), 20'000, parked));
+    // The first call takes the window; the second waits behind it.
+    ASSERT_EQ(scheduler.run_once(0), 2U);
+    ASSERT_EQ(scheduler.task_count(), 2U);
+
+    // With the transport cut, the cancel of the timed-out call cannot be sent.
+    runtime.client_endpoint().stop_all();
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (scheduler.task_count() > 0 && std::chrono::steady_clock::now() < deadline) {
+        scheduler.run_once(10'000);
+    }
+    EXPECT_EQ(first, ClientEventType::RESPONSE_TIMEOUT);
+    // The parked call is issued (and fails on the cut transport) instead of
+    // waiting for a slot nothing would free.
+    EXPECT_EQ(scheduler.task_count(), 0U);
+    EXPECT_EQ(parked, ClientEventType::NONE);
+}
+
+} // namespace
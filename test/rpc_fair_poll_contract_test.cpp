@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa_rpc_test::RpcRuntime;
+
+// Two services on one connection. "Service/Add" sorts first and has weight 3;
+// "Service/Sum" keeps the default weight of 1.
+constexpr const char* kConfigPath = "configs/service_config_fair.json";
+constexpr const char* kFloodedService = "Service/Add";
+constexpr const char* kQuietService = "Service/Sum";
+constexpr std::size_t kFloodedWeight = 3;
+constexpr std::size_t kWindow = 8;
+
+bool send_add(RpcRuntime& runtime, const char* service_name, long long a)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = a;
+    request_body.b = 0;
+    hakoniwa::pdu::rpc::PduData request_pdu;
+    if (!service.set_request_body(runtime.client(), service_name, request_body, request_pdu)) {
+        return false;
+    }
+    return runtime.client().call(service_name, request_pdu, 2'000'000);
+}
+
+// Services of the requests poll() returns, in order, until it reports NONE.
+std::vector<std::string> drain_services(RpcRuntime& runtime)
+{
+    std::vector<std::string> order;
+    RpcRequest request;
+    while (runtime.server().poll(request) == ServerEventType::REQUEST_IN) {
+        order.push_back(request.header.service_name);
+    }
+    return order;
+}
+
+TEST(RpcFairPollContractTest, FloodedServiceDoesNotStarveLaterServices)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    // A full window for the service that used to be polled first, then one
+    // request for the service behind it.
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        ASSERT_TRUE(send_add(runtime, kFloodedService, static_cast<long long>(i)));
+    }
+    ASSERT_TRUE(send_add(runtime, kQuietService, 0));
+    std::this_thread::sleep_for(300ms);
+
+    const auto order = drain_services(runtime);
+    ASSERT_EQ(order.size(), kWindow + 1);
+    std::size_t quiet_position = order.size();
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        if (order[i] == kQuietService) {
+            quiet_position = i;
+            break;
+        }
+    }
+    // It waits for at most one burst of the flooded service, not its backlog.
+    EXPECT_EQ(quiet_position, kFloodedWeight);
+}
+
+TEST(RpcFairPollContractTest, WeightSetsTheShareOfEachTurn)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        ASSERT_TRUE(send_add(runtime, kFloodedService, static_cast<long long>(i)));
+    }
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        ASSERT_TRUE(send_add(runtime, kQuietService, static_cast<long long>(i)));
+    }
+    std::this_thread::sleep_for(300ms);
+
+    const auto order = drain_services(runtime);
+    ASSERT_EQ(order.size(), 2 * kWindow);
+    // While both have work, each turn is kFloodedWeight requests of the
+    // weighted service followed by one of the other.
+    for (std::size_t turn = 0; turn < 2; ++turn) {
+        const std::size_t base = turn * (kFloodedWeight + 1);
+        for (std::size_t i = 0; i < kFloodedWeight; ++i) {
+            EXPECT_EQ(order[base + i], kFloodedService) << "position " << base + i;
+        }
+        EXPECT_EQ(order[base + kFloodedWeight], kQuietService) << "position " << base + kFloodedWeight;
+    }
+}
+
+TEST(RpcFairPollContractTest, PollBatchKeepsTheOrderOfSinglePolls)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        ASSERT_TRUE(send_add(runtime, kFloodedService, static_cast<long long>(i)));
+    }
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        ASSERT_TRUE(send_add(runtime, kQuietService, static_cast<long long>(i)));
+    }
+    std::this_thread::sleep_for(300ms);
+
+    // The first batch ends inside a turn of the weighted service; the second
+    // must finish that turn before the other service is served.
+    std::vector<RpcRequest> requests(2 * kWindow);
+    const std::span<RpcRequest> all(requests);
+    const std::size_t first = runtime.server().poll_batch(all.first(2));
+    ASSERT_EQ(first, 2U);
+    const std::size_t rest = runtime.server().poll_batch(all.subspan(first));
+    ASSERT_EQ(first + rest, 2 * kWindow);
+
+    const std::vector<std::string> expected = {
+        kFloodedService, kFloodedService, kFloodedService, kQuietService,
+        kFloodedService, kFloodedService, kFloodedService, kQuietService,
+        kFloodedService, kFloodedService, kQuietService, kQuietService,
+        kQuietService, kQuietService, kQuietService, kQuietService,
+    };
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        EXPECT_EQ(requests[i].header.service_name, expected[i]) << "position " << i;
+        EXPECT_EQ(requests[i].header.opcode, hakoniwa::pdu::rpc::HAKO_SERVICE_OPERATION_CODE_REQUEST);
+    }
+    RpcRequest request;
+    EXPECT_EQ(runtime.server().poll_batch(std::span<RpcRequest>(&request, 1)), 0U);
+}
+
+} // namespace
@@ -1,11 +1,11 @@
 #include <gtest/gtest.h>
 
-#include "hakoniwa/pdu/endpoint_container.hpp"
 #include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
 #include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
 #include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
 #include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
 #include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
 
 #include <chrono>
 #include <memory>
@@ -21,121 +21,14 @@ using hakoniwa::pdu::rpc::RpcResponse;
 using hakoniwa::pdu::rpc::RpcServicesClient;
 using hakoniwa::pdu::rpc::RpcServicesServer;
 using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa_rpc_test::RpcRuntime;
 
 constexpr const char* kConfigPath = "configs/service_config.json";
-constexpr const char* kEndpointConfigPath = "configs/endpoints.json";
-constexpr const char* kServerNodeId = "server_node";
-constexpr const char* kClientNodeId = "client_node";
-constexpr const char* kClientName = "TestClient";
 constexpr const char* kServiceName = "Service/Add";
 
-class RpcRuntime {
-public:
-    RpcRuntime()
-        : server_endpoint_(std::make_shared<hakoniwa::pdu::EndpointContainer>(
-              kServerNodeId, kEndpointConfigPath))
-        , client_endpoint_(std::make_shared<hakoniwa::pdu::EndpointContainer>(
-              kClientNodeId, kEndpointConfigPath))
-        , server_(kServerNodeId, "RpcServerEndpointImpl", kConfigPath, 1000)
-        , client_(kClientNodeId, kClientName, kConfigPath, "RpcClientEndpointImpl", 1000)
-    {
-    }
-
-    ~RpcRuntime()
-    {
-        stop();
-    }
-
-    bool start()
-    {
-        if (server_endpoint_->initialize() != HAKO_PDU_ERR_OK ||
-            client_endpoint_->initialize() != HAKO_PDU_ERR_OK) {
-            return false;
-        }
-        if (!server_.initialize_services(server_endpoint_) ||
-            !client_.initialize_services(client_endpoint_)) {
-            return false;
-        }
-        if (server_endpoint_->start_all() != HAKO_PDU_ERR_OK ||
-            client_endpoint_->start_all() != HAKO_PDU_ERR_OK) {
-            return false;
-        }
-        if (!server_.start_all_services() || !client_.start_all_services()) {
-            return false;
-        }
-
-        const auto deadline = std::chrono::steady_clock::now() + 3s;
-        while (!server_endpoint_->is_running_all() || !client_endpoint_->is_running_all()) {
-            if (std::chrono::steady_clock::now() >= deadline) {
-                return false;
-            }
-            std::this_thread::sleep_for(1ms);
-        }
-        started_ = true;
-        return true;
-    }
-
-    void stop()
-    {
-        if (!started_) {
-            return;
-        }
-        server_endpoint_->stop_all();
-        client_endpoint_->stop_all();
-        server_.stop_all_services();
-        client_.stop_all_services();
-        server_.clear_all_instances();
-        client_.clear_all_instances();
-        started_ = false;
-    }
-
-    ServerEventType wait_server_event(RpcRequest& request, std::chrono::milliseconds timeout = 2s)
-    {
-        const auto deadline = std::chrono::steady_clock::now() + timeout;
-        for (;;) {
-            const auto event = server_.poll(request);
-            if (event != ServerEventType::NONE) {
-                return event;
-            }
-            if (std::chrono::steady_clock::now() >= deadline) {
-                return ServerEventType::NONE;
-            }
-            std::this_thread::sleep_for(1ms);
-        }
-    }
-
-    ClientEventType wait_client_event(
-        std::string& service_name,
-        RpcResponse& response,
-        std::chrono::milliseconds timeout = 2s)
-    {
-        const auto deadline = std::chrono::steady_clock::now() + timeout;
-        for (;;) {
-            const auto event = client_.poll(service_name, response);
-            if (event != ClientEventType::NONE) {
-                return event;
-            }
-            if (std::chrono::steady_clock::now() >= deadline) {
-                return ClientEventType::NONE;
-            }
-            std::this_thread::sleep_for(1ms);
-        }
-    }
-
-    RpcServicesServer& server() { return server_; }
-    RpcServicesClient& client() { return client_; }
-
-private:
-    std::shared_ptr<hakoniwa::pdu::EndpointContainer> server_endpoint_;
-    std::shared_ptr<hakoniwa::pdu::EndpointContainer> client_endpoint_;
-    RpcServicesServer server_;
-    RpcServicesClient client_;
-    bool started_ = false;
-};
-
 TEST(RpcInfiniteWaitContractTest, TimeoutZeroDoesNotEmitTimeoutBeforeReply)
 {
-    RpcRuntime runtime;
+    RpcRuntime runtime(kConfigPath);
     ASSERT_TRUE(runtime.start());
 
     HakoRpcServiceServerTemplateType(AddTwoInts) service;
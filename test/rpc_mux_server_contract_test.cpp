@@ -14,6 +14,7 @@
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 namespace {
 
@@ -317,4 +318,37 @@ TEST(RpcMuxServerContractTest, ReusesAcceptedClientSessionForSequentialCalls)
     }
 }
 
+
+TEST(RpcMuxServerContractTest, PollBatchDrainsEveryConnectionInOneCall)
+{
+    MuxRuntime runtime;
+    ASSERT_TRUE(runtime.start());
+
+    ASSERT_TRUE(call_add(runtime.client0(), 1, 2));
+    ASSERT_TRUE(call_add(runtime.client1(), 3, 4));
+
+    // Collect until both have arrived; each call may return either or both.
+    std::vector<RpcMuxRequest> batch(4);
+    std::map<std::string, RpcMuxRequest> requests;
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (requests.size() < 2 && std::chrono::steady_clock::now() < deadline) {
+        const std::size_t count = runtime.server().poll_batch(batch);
+        ASSERT_LE(count, batch.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(batch[i].request.header.opcode, hakoniwa::pdu::rpc::HAKO_SERVICE_OPERATION_CODE_REQUEST);
+            requests.emplace(batch[i].request.header.client_name, std::move(batch[i]));
+        }
+        if (count == 0) {
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+    ASSERT_EQ(requests.size(), 2U);
+    EXPECT_NE(requests.at("TestClient0").connection_id, requests.at("TestClient1").connection_id);
+
+    ASSERT_TRUE(reply_add(runtime.server(), requests.at("TestClient0"), 1, 2));
+    ASSERT_TRUE(reply_add(runtime.server(), requests.at("TestClient1"), 3, 4));
+    EXPECT_TRUE(expect_response(runtime, runtime.client0(), 3));
+    EXPECT_TRUE(expect_response(runtime, runtime.client1(), 7));
+}
+
 } // namespace
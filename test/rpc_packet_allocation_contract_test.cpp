@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace {
+
+// Counts the allocations of the thread that turned counting on, so the
+// transport's own threads do not disturb the count.
+thread_local bool counting_allocations = false;
+thread_local std::size_t allocation_count = 0;
+
+class AllocationCounter {
+public:
+    AllocationCounter()
+    {
+        allocation_count = 0;
+        counting_allocations = true;
+    }
+    ~AllocationCounter() { counting_allocations = false; }
+    std::size_t count() const { return allocation_count; }
+};
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    if (counting_allocations) {
+        ++allocation_count;
+    }
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace {
+
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::PduData;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcResponse;
+using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa_rpc_test::RpcRuntime;
+
+// Service/Add, whose bodies are fixed-size.
+constexpr const char* kConfigPath = "configs/service_config.json";
+constexpr int kCalls = 100;
+
+TEST(RpcPacketAllocationContractTest, SteadyStateCallBuildsPacketsWithoutAllocating)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+    const std::string service_name = "Service/Add";
+    HakoRpcServiceServerTemplateType(AddTwoInts) client_service;
+    HakoRpcServiceServerTemplateType(AddTwoInts) server_service;
+
+    // One real round trip warms up both helpers and gives a request to reply to.
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = 1;
+    request_body.b = 2;
+    ASSERT_TRUE(client_service.call(runtime.client(), service_name, request_body, 1'000'000));
+    RpcRequest request;
+    ASSERT_EQ(runtime.wait_server_event(request), ServerEventType::REQUEST_IN);
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = 3;
+    ASSERT_TRUE(server_service.reply(
+        runtime.server(), request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+        response_body));
+    std::string responded_service;
+    RpcResponse response;
+    ASSERT_EQ(runtime.wait_client_event(responded_service, response), ClientEventType::RESPONSE_IN);
+
+    PduData request_pdu;
+    PduData response_pdu;
+    ASSERT_TRUE(client_service.set_request_body(runtime.client(), service_name, request_body, request_pdu));
+    ASSERT_TRUE(server_service.set_response_body(
+        runtime.server(), request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+        response_body, response_pdu));
+
+    bool built = true;
+    std::size_t allocations = 0;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < kCalls; ++i) {
+            request_body.a = i;
+            response_body.sum = i + 2;
+            built = built
+                && client_service.set_request_body(runtime.client(), service_name, request_body, request_pdu)
+                && server_service.set_response_body(
+                    runtime.server(), request,
+                    hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+                    hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+                    response_body, response_pdu);
+        }
+        allocations = counter.count();
+    }
+    EXPECT_TRUE(built);
+    EXPECT_EQ(allocations, 0U);
+
+    HakoCpp_AddTwoIntsResponse decoded{};
+    response.pdu = response_pdu;
+    ASSERT_TRUE(client_service.get_response_body(response, decoded));
+    EXPECT_EQ(decoded.sum, kCalls + 1);
+}
+
+} // namespace
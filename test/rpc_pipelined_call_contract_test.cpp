@@ -0,0 +1,413 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::RpcCallResult;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcResponse;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa_rpc_test::RpcRuntime;
+using hakoniwa_rpc_test::kClientName;
+
+constexpr const char* kConfigPath = "configs/service_config_pipelined.json";
+constexpr const char* kServiceName = "Service/Add";
+constexpr std::size_t kWindow = 4;
+
+bool send_add(RpcRuntime& runtime, long long a, long long b, uint64_t timeout_usec, Hako_uint32& request_id)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = a;
+    request_body.b = b;
+    hakoniwa::pdu::rpc::PduData request_pdu;
+    if (!service.set_request_body(runtime.client(), kServiceName, request_body, request_pdu)) {
+        return false;
+    }
+    return runtime.client().call(kServiceName, request_pdu, timeout_usec, request_id);
+}
+
+bool reply_add(RpcRuntime& runtime, RpcRequest& request)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest parsed_request{};
+    if (!service.get_request_body(request, parsed_request)) {
+        return false;
+    }
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = parsed_request.a + parsed_request.b;
+    return service.reply(
+        runtime.server(),
+        request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+        response_body);
+}
+
+TEST(RpcPipelinedCallContractTest, WindowOfCallsCompletesOutOfOrder)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    // Issue a full window back to back without waiting for any response.
+    std::map<Hako_uint32, long long> expected_sums;
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        const long long a = static_cast<long long>(i);
+        const long long b = static_cast<long long>(i) * 10;
+        Hako_uint32 request_id = 0;
+        ASSERT_TRUE(send_add(runtime, a, b, 1'000'000, request_id));
+        ASSERT_TRUE(expected_sums.emplace(request_id, a + b).second);
+    }
+    // The window is full, so the next call is refused locally.
+    Hako_uint32 rejected_id = 0;
+    EXPECT_FALSE(send_add(runtime, 1, 1, 1'000'000, rejected_id));
+
+    // The server admits the whole window instead of answering BUSY.
+    std::vector<RpcRequest> requests(kWindow);
+    for (auto& request : requests) {
+        ASSERT_EQ(runtime.wait_server_event(request), ServerEventType::REQUEST_IN);
+    }
+    for (auto it = requests.rbegin(); it != requests.rend(); ++it) {
+        ASSERT_TRUE(reply_add(runtime, *it));
+    }
+
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        std::string service_name;
+        RpcResponse response;
+        ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_IN);
+        auto it = expected_sums.find(response.header.request_id);
+        ASSERT_NE(it, expected_sums.end());
+        HakoCpp_AddTwoIntsResponse parsed_response{};
+        ASSERT_TRUE(service.get_response_body(response, parsed_response));
+        EXPECT_EQ(parsed_response.sum, it->second);
+        expected_sums.erase(it);
+    }
+    EXPECT_TRUE(expected_sums.empty());
+
+    // Completed requests free their slots.
+    Hako_uint32 next_id = 0;
+    EXPECT_TRUE(send_add(runtime, 2, 3, 1'000'000, next_id));
+}
+
+TEST(RpcPipelinedCallContractTest, ResponsesArePolledInArrivalOrder)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    std::vector<Hako_uint32> issued(kWindow);
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        ASSERT_TRUE(send_add(runtime, static_cast<long long>(i), 0, 1'000'000, issued[i]));
+    }
+    std::vector<RpcRequest> requests(kWindow);
+    for (auto& request : requests) {
+        ASSERT_EQ(runtime.wait_server_event(request), ServerEventType::REQUEST_IN);
+    }
+    // Answer the newest call first, one at a time.
+    std::vector<Hako_uint32> answered;
+    for (auto it = requests.rbegin(); it != requests.rend(); ++it) {
+        ASSERT_TRUE(reply_add(runtime, *it));
+        answered.push_back(it->header.request_id);
+        std::this_thread::sleep_for(10ms);
+    }
+
+    std::vector<Hako_uint32> polled;
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        std::string service_name;
+        RpcResponse response;
+        ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_IN);
+        polled.push_back(response.header.request_id);
+    }
+    EXPECT_EQ(polled, answered);
+}
+
+TEST(RpcPipelinedCallContractTest, PollWaitReturnsOnceNoCallIsLeft)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    Hako_uint32 answered_id = 0;
+    Hako_uint32 cancelled_id = 0;
+    ASSERT_TRUE(send_add(runtime, 1, 2, 1'000'000, answered_id));
+    ASSERT_TRUE(send_add(runtime, 3, 4, 1'000'000, cancelled_id));
+    for (int i = 0; i < 2; ++i) {
+        RpcRequest request;
+        ASSERT_EQ(runtime.wait_server_event(request), ServerEventType::REQUEST_IN);
+        if (request.header.request_id == answered_id) {
+            ASSERT_TRUE(reply_add(runtime, request));
+        }
+    }
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_EQ(runtime.client().poll_wait(service_name, response, 2'000'000), ClientEventType::RESPONSE_IN);
+
+    ASSERT_TRUE(runtime.client().send_cancel_request(kServiceName, cancelled_id));
+    RpcRequest cancel_request;
+    ASSERT_EQ(runtime.wait_server_event(cancel_request), ServerEventType::REQUEST_CANCEL);
+    hakoniwa::pdu::rpc::PduData cancel_pdu;
+    runtime.server().create_reply_buffer(cancel_request.header,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_CANCELED,
+        cancel_pdu);
+    runtime.server().send_cancel_reply(cancel_request.header, cancel_pdu);
+    ASSERT_EQ(runtime.client().poll_wait(service_name, response, 2'000'000), ClientEventType::RESPONSE_CANCEL);
+
+    // Both calls are complete, so a wait without limit returns at once.
+    const auto started = std::chrono::steady_clock::now();
+    EXPECT_EQ(runtime.client().poll_wait(service_name, response, 0), ClientEventType::NONE);
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 1s);
+}
+
+TEST(RpcPipelinedCallContractTest, CancelAndTimeoutAreTrackedPerRequest)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    Hako_uint32 slow_id = 0;
+    Hako_uint32 fast_id = 0;
+    ASSERT_TRUE(send_add(runtime, 1, 2, 50'000, slow_id));
+    ASSERT_TRUE(send_add(runtime, 3, 4, 1'000'000, fast_id));
+    ASSERT_NE(slow_id, fast_id);
+
+    RpcRequest slow_request;
+    RpcRequest fast_request;
+    ASSERT_EQ(runtime.wait_server_event(slow_request), ServerEventType::REQUEST_IN);
+    ASSERT_EQ(runtime.wait_server_event(fast_request), ServerEventType::REQUEST_IN);
+    ASSERT_EQ(slow_request.header.request_id, slow_id);
+    ASSERT_EQ(fast_request.header.request_id, fast_id);
+
+    // Only the request with the short deadline times out.
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_TIMEOUT);
+    EXPECT_EQ(response.header.request_id, slow_id);
+
+    // The other request still completes while the first one is timed out.
+    ASSERT_TRUE(reply_add(runtime, fast_request));
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    ClientEventType event = ClientEventType::NONE;
+    while (std::chrono::steady_clock::now() < deadline) {
+        event = runtime.client().poll(service_name, response);
+        if (event == ClientEventType::RESPONSE_IN) {
+            break;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_EQ(event, ClientEventType::RESPONSE_IN);
+    EXPECT_EQ(response.header.request_id, fast_id);
+
+    // Cancel exactly the timed-out request.
+    ASSERT_TRUE(runtime.client().send_cancel_request(kServiceName, slow_id));
+    RpcRequest cancel_request;
+    ASSERT_EQ(runtime.wait_server_event(cancel_request), ServerEventType::REQUEST_CANCEL);
+    ASSERT_EQ(cancel_request.header.request_id, slow_id);
+
+    hakoniwa::pdu::rpc::PduData cancel_response;
+    runtime.server().create_reply_buffer(
+        cancel_request.header,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_CANCELED,
+        cancel_response);
+    runtime.server().send_cancel_reply(cancel_request.header, cancel_response);
+
+    response = {};
+    ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_CANCEL);
+    EXPECT_EQ(response.header.request_id, slow_id);
+}
+
+TEST(RpcPipelinedCallContractTest, CallerOwnedRequestBufferCarriesItsOwnRequestId)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    // A buffer that is too small reports the size without issuing an id.
+    std::size_t request_size = 0;
+    EXPECT_FALSE(runtime.client().create_request_buffer(kServiceName, nullptr, 0, request_size));
+    ASSERT_GT(request_size, 0U);
+
+    std::vector<uint8_t> first(request_size);
+    std::vector<uint8_t> second(request_size);
+    std::size_t written = 0;
+    ASSERT_TRUE(runtime.client().create_request_buffer(kServiceName, first.data(), first.size(), written));
+    ASSERT_EQ(written, request_size);
+    ASSERT_TRUE(runtime.client().create_request_buffer(kServiceName, second.data(), second.size(), written));
+
+    hako::pdu::PduConvertor<HakoCpp_ServiceRequestHeader, hako::pdu::msgs::hako_srv_msgs::ServiceRequestHeader> convertor;
+    HakoCpp_ServiceRequestHeader first_header;
+    HakoCpp_ServiceRequestHeader second_header;
+    ASSERT_TRUE(convertor.pdu2cpp(reinterpret_cast<char*>(first.data()), first_header));
+    ASSERT_TRUE(convertor.pdu2cpp(reinterpret_cast<char*>(second.data()), second_header));
+    EXPECT_EQ(first_header.service_name, kServiceName);
+    EXPECT_EQ(first_header.client_name, kClientName);
+    EXPECT_EQ(first_header.opcode, hakoniwa::pdu::rpc::HAKO_SERVICE_OPERATION_CODE_REQUEST);
+    EXPECT_NE(first_header.request_id, second_header.request_id);
+
+    // The patched packet is a complete request the server accepts.
+    Hako_uint32 request_id = 0;
+    ASSERT_TRUE(runtime.client().call(
+        kServiceName, hakoniwa::pdu::rpc::PduData(second.begin(), second.end()), 1'000'000, request_id));
+    EXPECT_EQ(request_id, second_header.request_id);
+    RpcRequest request;
+    ASSERT_EQ(runtime.wait_server_event(request), ServerEventType::REQUEST_IN);
+    EXPECT_EQ(request.header.request_id, second_header.request_id);
+    EXPECT_EQ(request.header.client_name, kClientName);
+}
+
+TEST(RpcPipelinedCallContractTest, ReplyBuffersArePatchedPerRequest)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    Hako_uint32 first_id = 0;
+    Hako_uint32 second_id = 0;
+    ASSERT_TRUE(send_add(runtime, 1, 2, 1'000'000, first_id));
+    ASSERT_TRUE(send_add(runtime, 3, 4, 1'000'000, second_id));
+    RpcRequest first_request;
+    RpcRequest second_request;
+    ASSERT_EQ(runtime.wait_server_event(first_request), ServerEventType::REQUEST_IN);
+    ASSERT_EQ(runtime.wait_server_event(second_request), ServerEventType::REQUEST_IN);
+
+    // Reuse one buffer for both replies; nothing from the first may leak.
+    hako::pdu::PduConvertor<HakoCpp_ServiceResponseHeader, hako::pdu::msgs::hako_srv_msgs::ServiceResponseHeader> convertor;
+    hakoniwa::pdu::rpc::PduData reply;
+    HakoCpp_ServiceResponseHeader header;
+    runtime.server().create_reply_buffer(first_request.header,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_ERROR, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_INVALID, reply);
+    ASSERT_TRUE(convertor.pdu2cpp(reinterpret_cast<char*>(reply.data()), header));
+    EXPECT_EQ(header.request_id, first_id);
+    EXPECT_EQ(header.status, hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_ERROR);
+    EXPECT_EQ(header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_INVALID);
+
+    runtime.server().create_reply_buffer(second_request.header,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK, reply);
+    ASSERT_TRUE(convertor.pdu2cpp(reinterpret_cast<char*>(reply.data()), header));
+    EXPECT_EQ(header.request_id, second_id);
+    EXPECT_EQ(header.service_name, kServiceName);
+    EXPECT_EQ(header.client_name, kClientName);
+    EXPECT_EQ(header.status, hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE);
+    EXPECT_EQ(header.processing_percentage, 100);
+    EXPECT_EQ(header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK);
+}
+
+TEST(RpcPipelinedCallContractTest, QueuedResponsesAreReportedWithoutNewTraffic)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    std::vector<RpcRequest> requests(kWindow);
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        Hako_uint32 request_id = 0;
+        ASSERT_TRUE(send_add(runtime, 1, static_cast<long long>(i), 1'000'000, request_id));
+    }
+    for (auto& request : requests) {
+        ASSERT_EQ(runtime.wait_server_event(request), ServerEventType::REQUEST_IN);
+    }
+    for (auto& request : requests) {
+        ASSERT_TRUE(reply_add(runtime, request));
+    }
+    // Let every response arrive, so the client endpoint is notified while
+    // its earlier responses are still queued.
+    std::this_thread::sleep_for(200ms);
+
+    // Back to back, with nothing new arriving: the endpoint must stay on
+    // the ready list until its queue is drained.
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        std::string service_name;
+        RpcResponse response;
+        ASSERT_EQ(runtime.client().poll(service_name, response), ClientEventType::RESPONSE_IN) << "response " << i;
+        EXPECT_EQ(service_name, kServiceName);
+    }
+    std::string service_name;
+    RpcResponse response;
+    EXPECT_EQ(runtime.client().poll(service_name, response), ClientEventType::NONE);
+}
+
+TEST(RpcPipelinedCallContractTest, ExpiredCallIsReportedByPollWithoutTraffic)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    // The server never answers, so only the call deadline can list the
+    // endpoint as ready.
+    Hako_uint32 request_id = 0;
+    ASSERT_TRUE(send_add(runtime, 1, 1, 50'000, request_id));
+    std::string service_name;
+    RpcResponse response;
+    EXPECT_EQ(runtime.client().poll(service_name, response), ClientEventType::NONE);
+    std::this_thread::sleep_for(100ms);
+
+    // Reported once, although the call stays in flight until it is cancelled.
+    ASSERT_EQ(runtime.client().poll(service_name, response), ClientEventType::RESPONSE_TIMEOUT);
+    EXPECT_EQ(service_name, kServiceName);
+    EXPECT_EQ(response.header.request_id, request_id);
+    EXPECT_EQ(runtime.client().poll(service_name, response), ClientEventType::NONE);
+}
+
+TEST(RpcPipelinedCallContractTest, PollBatchDrainsResponsesAndTimeoutsOnce)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    std::map<Hako_uint32, long long> expected_sums;
+    for (std::size_t i = 0; i + 1 < kWindow; ++i) {
+        Hako_uint32 request_id = 0;
+        ASSERT_TRUE(send_add(runtime, static_cast<long long>(i), 1, 1'000'000, request_id));
+        expected_sums.emplace(request_id, static_cast<long long>(i) + 1);
+    }
+    Hako_uint32 expiring_id = 0;
+    ASSERT_TRUE(send_add(runtime, 0, 0, 20'000, expiring_id));
+
+    // Answer all but the last call, then let it time out.
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        RpcRequest request;
+        ASSERT_EQ(runtime.wait_server_event(request), ServerEventType::REQUEST_IN);
+        if (request.header.request_id != expiring_id) {
+            ASSERT_TRUE(reply_add(runtime, request));
+        }
+    }
+    std::this_thread::sleep_for(100ms);
+
+    std::vector<RpcCallResult> results(kWindow * 2);
+    ASSERT_EQ(runtime.client().poll_batch(std::span<RpcCallResult>(results)), kWindow);
+    std::size_t responses = 0;
+    std::size_t timeouts = 0;
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    for (std::size_t i = 0; i < kWindow; ++i) {
+        EXPECT_EQ(results[i].response.header.service_name, kServiceName);
+        if (results[i].event == ClientEventType::RESPONSE_TIMEOUT) {
+            EXPECT_EQ(results[i].response.header.request_id, expiring_id);
+            ++timeouts;
+            continue;
+        }
+        ASSERT_EQ(results[i].event, ClientEventType::RESPONSE_IN);
+        HakoCpp_AddTwoIntsResponse body{};
+        ASSERT_TRUE(service.get_response_body(results[i].response, body));
+        EXPECT_EQ(body.sum, expected_sums.at(results[i].response.header.request_id));
+        ++responses;
+    }
+    EXPECT_EQ(responses, kWindow - 1);
+    EXPECT_EQ(timeouts, 1U);
+
+    // The timed-out call stays in flight, but is not reported again.
+    EXPECT_EQ(runtime.client().poll_batch(std::span<RpcCallResult>(results)), 0U);
+}
+
+} // namespace
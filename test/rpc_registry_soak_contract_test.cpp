@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/endpoint_container.hpp"
+#include "hakoniwa/pdu/rpc/rpc_client_endpoint_impl.hpp"
+#include "hakoniwa/pdu/rpc/rpc_server_endpoint_impl.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace {
+
+using hakoniwa::pdu::rpc::RpcClientEndpointImpl;
+using hakoniwa::pdu::rpc::RpcServerEndpointImpl;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+
+constexpr const char* kConfigPath = "configs/service_config.json";
+constexpr const char* kEndpointConfigPath = "configs/endpoints.json";
+constexpr const char* kServerNodeId = "server_node";
+constexpr const char* kClientNodeId = "client_node";
+constexpr const char* kServerEndpointId = "server_ep_id";
+constexpr const char* kClientName = "TestClient";
+// Each cycle builds what RpcServicesMuxServer builds for one accepted
+// connection: an RpcServicesServer initialized on an existing Endpoint.
+constexpr std::size_t kCycles = 5000;
+constexpr std::size_t kWarmupCycles = 500;
+// Before endpoints were released, every cycle kept its endpoint, buffers and
+// client tables alive, which is far more than this over kCycles.
+constexpr std::size_t kMaxRssGrowthBytes = 4 * 1024 * 1024;
+
+// Resident set size in bytes, or 0 where it cannot be read.
+std::size_t resident_set_bytes()
+{
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    std::size_t total_pages = 0;
+    std::size_t resident_pages = 0;
+    if (statm >> total_pages >> resident_pages) {
+        return resident_pages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
+
+TEST(RpcRegistrySoakContractTest, EndpointsAreReleasedWithTheirOwner)
+{
+    auto server_container = std::make_shared<hakoniwa::pdu::EndpointContainer>(kServerNodeId, kEndpointConfigPath);
+    auto client_container = std::make_shared<hakoniwa::pdu::EndpointContainer>(kClientNodeId, kEndpointConfigPath);
+    ASSERT_EQ(server_container->initialize(), HAKO_PDU_ERR_OK);
+    ASSERT_EQ(client_container->initialize(), HAKO_PDU_ERR_OK);
+    auto server_endpoint = server_container->ref(kServerEndpointId);
+    ASSERT_NE(server_endpoint, nullptr);
+
+    {
+        RpcServicesServer server(kServerNodeId, "RpcServerEndpointImpl", kConfigPath, 1000);
+        RpcServicesClient client(kClientNodeId, kClientName, kConfigPath, "RpcClientEndpointImpl", 1000);
+        ASSERT_TRUE(server.initialize_services(server_endpoint));
+        ASSERT_TRUE(client.initialize_services(client_container));
+        EXPECT_EQ(RpcServerEndpointImpl::instance_count(), 1U);
+        EXPECT_EQ(RpcClientEndpointImpl::instance_count(), 1U);
+    }
+    // No clear_all_instances(): dropping the owners must be enough.
+    EXPECT_EQ(RpcServerEndpointImpl::instance_count(), 0U);
+    EXPECT_EQ(RpcClientEndpointImpl::instance_count(), 0U);
+}
+
+TEST(RpcRegistrySoakContractTest, ConnectionChurnKeepsMemoryFlat)
+{
+    auto server_container = std::make_shared<hakoniwa::pdu::EndpointContainer>(kServerNodeId, kEndpointConfigPath);
+    ASSERT_EQ(server_container->initialize(), HAKO_PDU_ERR_OK);
+    auto server_endpoint = server_container->ref(kServerEndpointId);
+    ASSERT_NE(server_endpoint, nullptr);
+
+    std::size_t baseline_rss = 0;
+    for (std::size_t cycle = 0; cycle < kCycles; ++cycle) {
+        if (cycle == kWarmupCycles) {
+            baseline_rss = resident_set_bytes();
+        }
+        auto server = std::make_unique<RpcServicesServer>(kServerNodeId, "RpcServerEndpointImpl", kConfigPath, 1000);
+        ASSERT_TRUE(server->initialize_services(server_endpoint));
+        ASSERT_TRUE(server->start_all_services());
+        ASSERT_EQ(RpcServerEndpointImpl::instance_count(), 1U);
+        server->stop_all_services();
+        server.reset();
+        ASSERT_EQ(RpcServerEndpointImpl::instance_count(), 0U);
+    }
+
+    const auto final_rss = resident_set_bytes();
+    if (baseline_rss == 0 || final_rss == 0) {
+        GTEST_SKIP() << "resident set size is not available on this platform";
+    }
+    EXPECT_LT(final_rss, baseline_rss + kMaxRssGrowthBytes)
+        << "baseline=" << baseline_rss << " final=" << final_rss;
+}
+
+} // namespace
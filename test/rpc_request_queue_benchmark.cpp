@@ -0,0 +1,151 @@
+// Measures RpcServerEndpointImpl::poll() dequeue cost against the depth of the
+// received-request backlog. With an O(1) queue the per-poll cost must stay
+// flat while the backlog grows by orders of magnitude.
+//
+// Usage: hakoniwa_pdu_rpc_request_queue_benchmark
+#include "hakoniwa/pdu/endpoint_container.hpp"
+#include "hakoniwa/pdu/rpc/rpc_server_endpoint_impl.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/time_source/time_source_factory.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::PduData;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcServerEndpointImpl;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::ServerEventType;
+
+constexpr const char* kConfigPath = RPC_BENCHMARK_SERVICE_CONFIG_PATH;
+constexpr const char* kEndpointConfigPath = RPC_BENCHMARK_ENDPOINTS_CONFIG_PATH;
+constexpr const char* kServerNodeId = "server_node";
+constexpr const char* kClientNodeId = "client_node";
+constexpr const char* kServerEndpointId = "server_ep_id";
+constexpr const char* kClientName = "TestClient";
+constexpr const char* kServiceName = "Service/Add";
+constexpr std::size_t kBacklogDepths[] = {16, 256, 4096, 16384};
+
+// Exposes the receive-side enqueue so the benchmark can build a backlog
+// without depending on transport delivery timing.
+class BacklogServerEndpoint : public RpcServerEndpointImpl {
+public:
+    using RpcServerEndpointImpl::RpcServerEndpointImpl;
+    using RpcServerEndpointImpl::put_pending_request;
+};
+
+bool make_request_pdu(const std::shared_ptr<hakoniwa::pdu::Endpoint>& endpoint, PduData& pdu)
+{
+    hakoniwa::pdu::PduKey pdu_key = {kServiceName, std::string(kClientName) + "Req"};
+    const auto pdu_size = endpoint->get_pdu_size(pdu_key);
+    if (pdu_size == 0) {
+        return false;
+    }
+    pdu.resize(pdu_size);
+    HakoCpp_ServiceRequestHeader header;
+    header.request_id = 1;
+    header.client_name = kClientName;
+    header.service_name = kServiceName;
+    header.opcode = hakoniwa::pdu::rpc::HAKO_SERVICE_OPERATION_CODE_REQUEST;
+    header.status_poll_interval_msec = 0;
+    hako::pdu::PduConvertor<HakoCpp_ServiceRequestHeader, hako::pdu::msgs::hako_srv_msgs::ServiceRequestHeader> convertor;
+    return convertor.cpp2pdu(header, reinterpret_cast<char*>(pdu.data()), static_cast<int>(pdu.size())) > 0;
+}
+
+} // namespace
+
+int main()
+{
+    std::ifstream ifs(kConfigPath);
+    if (!ifs.is_open()) {
+        std::fprintf(stderr, "ERROR: cannot open %s\n", kConfigPath);
+        return 1;
+    }
+    nlohmann::json service_config = nlohmann::json::parse(ifs);
+    nlohmann::json service_entry = service_config["services"][0];
+    service_entry["requestQueueCapacity"] = kBacklogDepths[std::size(kBacklogDepths) - 1];
+    const int pdu_meta_data_size = service_config.value("pduMetaDataSize", 24);
+
+    auto server_container = std::make_shared<hakoniwa::pdu::EndpointContainer>(kServerNodeId, kEndpointConfigPath);
+    auto client_container = std::make_shared<hakoniwa::pdu::EndpointContainer>(kClientNodeId, kEndpointConfigPath);
+    if (server_container->initialize() != HAKO_PDU_ERR_OK || client_container->initialize() != HAKO_PDU_ERR_OK) {
+        std::fprintf(stderr, "ERROR: failed to initialize endpoints\n");
+        return 1;
+    }
+    auto server_endpoint = server_container->ref(kServerEndpointId);
+    auto server = std::make_shared<BacklogServerEndpoint>(
+        kServiceName, 1000, server_endpoint, hakoniwa::time_source::create_time_source("real", 1000));
+    RpcServicesClient client(kClientNodeId, kClientName, kConfigPath, "RpcClientEndpointImpl", 1000);
+    if (!server->initialize(service_entry, pdu_meta_data_size) || !client.initialize_services(client_container)) {
+        std::fprintf(stderr, "ERROR: failed to initialize RPC endpoints\n");
+        return 1;
+    }
+    if (server_container->start_all() != HAKO_PDU_ERR_OK || client_container->start_all() != HAKO_PDU_ERR_OK) {
+        std::fprintf(stderr, "ERROR: failed to start endpoints\n");
+        return 1;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + 3s;
+    while (!server_container->is_running_all() || !client_container->is_running_all()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            std::fprintf(stderr, "ERROR: endpoints did not start\n");
+            return 1;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+
+    PduData request_pdu;
+    if (!make_request_pdu(server_endpoint, request_pdu)) {
+        std::fprintf(stderr, "ERROR: failed to build request PDU\n");
+        return 1;
+    }
+    const hakoniwa::pdu::PduKey request_key = {kServiceName, std::string(kClientName) + "Req"};
+
+    std::printf("%12s %16s\n", "backlog", "ns/dequeue");
+    int rc = 0;
+    for (const auto depth : kBacklogDepths) {
+        for (std::size_t i = 0; i < depth; ++i) {
+            server->put_pending_request(request_key, PduData(request_pdu));
+        }
+        std::chrono::nanoseconds poll_time{0};
+        std::size_t dequeued = 0;
+        for (std::size_t i = 0; i < depth; ++i) {
+            RpcRequest request;
+            const auto start = std::chrono::steady_clock::now();
+            const auto event = server->poll(request);
+            poll_time += std::chrono::steady_clock::now() - start;
+            if (event != ServerEventType::REQUEST_IN) {
+                break;
+            }
+            ++dequeued;
+            // Return the client to IDLE so the next queued request is accepted.
+            PduData reply;
+            server->create_reply_buffer(request.header, hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+                hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK, reply);
+            server->send_reply(request.client_name, reply);
+        }
+        if (dequeued != depth) {
+            std::fprintf(stderr, "ERROR: dequeued %zu of %zu requests\n", dequeued, depth);
+            rc = 1;
+            break;
+        }
+        std::printf("%12zu %16.1f\n", depth, static_cast<double>(poll_time.count()) / static_cast<double>(depth));
+    }
+
+    server_container->stop_all();
+    client_container->stop_all();
+    server->clear_pending_requests();
+    client.stop_all_services();
+    RpcServerEndpointImpl::clear_all_instances();
+    client.clear_all_instances();
+    return rc;
+}
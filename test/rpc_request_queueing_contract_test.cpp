@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcResponse;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa_rpc_test::RpcRuntime;
+
+// The server admits one request per client and queues one more. The client
+// config allows a larger window so it can outrun the server.
+constexpr const char* kServerConfigPath = "configs/service_config_queued.json";
+constexpr const char* kClientConfigPath = "configs/service_config_pipelined.json";
+constexpr const char* kServiceName = "Service/Add";
+
+bool send_add(RpcRuntime& runtime, long long a, long long b, uint64_t timeout_usec, Hako_uint32& request_id)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = a;
+    request_body.b = b;
+    hakoniwa::pdu::rpc::PduData request_pdu;
+    if (!service.set_request_body(runtime.client(), kServiceName, request_body, request_pdu)) {
+        return false;
+    }
+    return runtime.client().call(kServiceName, request_pdu, timeout_usec, request_id);
+}
+
+bool reply_add(RpcRuntime& runtime, RpcRequest& request)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest parsed_request{};
+    if (!service.get_request_body(request, parsed_request)) {
+        return false;
+    }
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = parsed_request.a + parsed_request.b;
+    return service.reply(
+        runtime.server(),
+        request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+        response_body);
+}
+
+TEST(RpcRequestQueueingContractTest, QueuedRequestIsReleasedByReply)
+{
+    RpcRuntime runtime(kServerConfigPath, kClientConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    Hako_uint32 first_id = 0;
+    Hako_uint32 queued_id = 0;
+    Hako_uint32 busy_id = 0;
+    ASSERT_TRUE(send_add(runtime, 1, 2, 1'000'000, first_id));
+    ASSERT_TRUE(send_add(runtime, 3, 4, 1'000'000, queued_id));
+    ASSERT_TRUE(send_add(runtime, 5, 6, 1'000'000, busy_id));
+
+    RpcRequest first_request;
+    ASSERT_EQ(runtime.wait_server_event(first_request), ServerEventType::REQUEST_IN);
+    ASSERT_EQ(first_request.header.request_id, first_id);
+
+    // The second request waits in the queue; the third overflows it and is
+    // answered BUSY so backpressure stays explicit.
+    std::string service_name;
+    RpcResponse response;
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    ClientEventType event = ClientEventType::NONE;
+    while (std::chrono::steady_clock::now() < deadline) {
+        RpcRequest request;
+        EXPECT_EQ(runtime.server().poll(request), ServerEventType::NONE);
+        event = runtime.client().poll(service_name, response);
+        if (event != ClientEventType::NONE) {
+            break;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_EQ(event, ClientEventType::RESPONSE_IN);
+    EXPECT_EQ(response.header.request_id, busy_id);
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_BUSY);
+
+    // Replying to the running request admits the queued one.
+    ASSERT_TRUE(reply_add(runtime, first_request));
+    RpcRequest queued_request;
+    ASSERT_EQ(runtime.wait_server_event(queued_request), ServerEventType::REQUEST_IN);
+    ASSERT_EQ(queued_request.header.request_id, queued_id);
+    ASSERT_TRUE(reply_add(runtime, queued_request));
+
+    for (const auto expected : {first_id, queued_id}) {
+        response = {};
+        ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_IN);
+        EXPECT_EQ(response.header.request_id, expected);
+        EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK);
+    }
+}
+
+TEST(RpcRequestQueueingContractTest, CancelRemovesQueuedRequest)
+{
+    RpcRuntime runtime(kServerConfigPath, kClientConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    Hako_uint32 first_id = 0;
+    Hako_uint32 queued_id = 0;
+    ASSERT_TRUE(send_add(runtime, 1, 2, 1'000'000, first_id));
+    ASSERT_TRUE(send_add(runtime, 3, 4, 1'000'000, queued_id));
+
+    RpcRequest first_request;
+    ASSERT_EQ(runtime.wait_server_event(first_request), ServerEventType::REQUEST_IN);
+    ASSERT_TRUE(runtime.client().send_cancel_request(kServiceName, queued_id));
+
+    // The server cancels the queued request itself; the application never sees it.
+    std::string service_name;
+    RpcResponse response;
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    ClientEventType event = ClientEventType::NONE;
+    while (std::chrono::steady_clock::now() < deadline) {
+        RpcRequest request;
+        EXPECT_EQ(runtime.server().poll(request), ServerEventType::NONE);
+        event = runtime.client().poll(service_name, response);
+        if (event != ClientEventType::NONE) {
+            break;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_EQ(event, ClientEventType::RESPONSE_CANCEL);
+    EXPECT_EQ(response.header.request_id, queued_id);
+
+    // Nothing is left to release after the running request completes.
+    ASSERT_TRUE(reply_add(runtime, first_request));
+    response = {};
+    ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_IN);
+    EXPECT_EQ(response.header.request_id, first_id);
+    RpcRequest request;
+    EXPECT_EQ(runtime.wait_server_event(request, 100ms), ServerEventType::NONE);
+}
+
+TEST(RpcRequestQueueingContractTest, ClearingPendingRequestsFreesTheWindow)
+{
+    RpcRuntime runtime(kServerConfigPath, kClientConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    Hako_uint32 first_id = 0;
+    Hako_uint32 queued_id = 0;
+    Hako_uint32 busy_id = 0;
+    ASSERT_TRUE(send_add(runtime, 1, 2, 1'000'000, first_id));
+    ASSERT_TRUE(send_add(runtime, 3, 4, 1'000'000, queued_id));
+    ASSERT_TRUE(send_add(runtime, 5, 6, 1'000'000, busy_id));
+
+    RpcRequest first_request;
+    ASSERT_EQ(runtime.wait_server_event(first_request), ServerEventType::REQUEST_IN);
+
+    // Once the third request is answered BUSY, the window and the queue are full.
+    std::string service_name;
+    RpcResponse response;
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    ClientEventType event = ClientEventType::NONE;
+    while (std::chrono::steady_clock::now() < deadline) {
+        RpcRequest request;
+        EXPECT_EQ(runtime.server().poll(request), ServerEventType::NONE);
+        event = runtime.client().poll(service_name, response);
+        if (event != ClientEventType::NONE) {
+            break;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_EQ(event, ClientEventType::RESPONSE_IN);
+    ASSERT_EQ(response.header.request_id, busy_id);
+
+    // The reply releases the queued request into the window, and the clear
+    // drops it before the application polls it, answering it ERROR.
+    ASSERT_TRUE(reply_add(runtime, first_request));
+    runtime.server().stop_all_services();
+    std::map<Hako_uint32, Hako_int32> result_codes;
+    for (int i = 0; i < 2; ++i) {
+        response = {};
+        ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_IN);
+        result_codes[response.header.request_id] = response.header.result_code;
+    }
+    EXPECT_EQ(result_codes, (std::map<Hako_uint32, Hako_int32>{
+        {first_id, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK},
+        {queued_id, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_ERROR}}));
+
+    // The dropped request no longer holds the window, so a new one is admitted.
+    Hako_uint32 next_id = 0;
+    ASSERT_TRUE(send_add(runtime, 7, 8, 1'000'000, next_id));
+    RpcRequest next_request;
+    ASSERT_EQ(runtime.wait_server_event(next_request), ServerEventType::REQUEST_IN);
+    EXPECT_EQ(next_request.header.request_id, next_id);
+}
+
+TEST(RpcRequestQueueingContractTest, QueuedRequestIsAnsweredWhenServicesStop)
+{
+    RpcRuntime runtime(kServerConfigPath, kClientConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    Hako_uint32 first_id = 0;
+    Hako_uint32 queued_id = 0;
+    Hako_uint32 busy_id = 0;
+    ASSERT_TRUE(send_add(runtime, 1, 2, 0, first_id));
+    ASSERT_TRUE(send_add(runtime, 3, 4, 0, queued_id));
+    ASSERT_TRUE(send_add(runtime, 5, 6, 0, busy_id));
+
+    RpcRequest first_request;
+    ASSERT_EQ(runtime.wait_server_event(first_request), ServerEventType::REQUEST_IN);
+    // The BUSY reply to the third request shows the second one is queued.
+    std::string service_name;
+    RpcResponse response;
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    ClientEventType event = ClientEventType::NONE;
+    while (std::chrono::steady_clock::now() < deadline) {
+        RpcRequest request;
+        EXPECT_EQ(runtime.server().poll(request), ServerEventType::NONE);
+        event = runtime.client().poll(service_name, response);
+        if (event != ClientEventType::NONE) {
+            break;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_EQ(event, ClientEventType::RESPONSE_IN);
+    ASSERT_EQ(response.header.request_id, busy_id);
+
+    // Without a timeout, the caller would wait forever for a dropped request.
+    runtime.server().stop_all_services();
+    response = {};
+    ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_IN);
+    EXPECT_EQ(response.header.request_id, queued_id);
+    EXPECT_EQ(response.header.status, hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_ERROR);
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_ERROR);
+}
+
+} // namespace
@@ -0,0 +1,180 @@
+// Measures RpcServiceExecutor throughput against its worker count. Each of
+// kServices services gets a full window of calls whose handler takes about
+// kHandlerTime, so with enough workers the handlers overlap and throughput
+// grows with the pool until it reaches the number of services.
+//
+// Usage: hakoniwa_pdu_rpc_service_executor_benchmark
+#include "hakoniwa/pdu/endpoint_container.hpp"
+#include "hakoniwa/pdu/rpc/rpc_service_executor.hpp"
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcResponse;
+using hakoniwa::pdu::rpc::RpcServiceExecutor;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+
+constexpr const char* kConfigPath = RPC_BENCHMARK_SERVICE_CONFIG_PATH;
+constexpr const char* kEndpointConfigPath = RPC_BENCHMARK_ENDPOINTS_CONFIG_PATH;
+constexpr const char* kServerNodeId = "server_node";
+constexpr const char* kClientNodeId = "client_node";
+constexpr const char* kClientName = "TestClient";
+constexpr std::size_t kServices = 8;
+constexpr std::size_t kWindow = 4;
+constexpr std::size_t kCallsPerService = 100;
+constexpr auto kHandlerTime = 500us;
+constexpr std::size_t kWorkerCounts[] = {1, 2, 4, 8};
+
+// Writes a copy of the benchmark service config with kServices services,
+// each allowing kWindow calls in flight.
+bool write_service_config(const std::filesystem::path& path)
+{
+    std::ifstream ifs(kConfigPath);
+    if (!ifs.is_open()) {
+        std::fprintf(stderr, "ERROR: cannot open %s\n", kConfigPath);
+        return false;
+    }
+    nlohmann::json config = nlohmann::json::parse(ifs);
+    const nlohmann::json templ = config["services"][0];
+    config["services"] = nlohmann::json::array();
+    for (std::size_t i = 0; i < kServices; ++i) {
+        nlohmann::json service = templ;
+        service["name"] = "Service/Add" + std::to_string(i);
+        service["maxInFlight"] = kWindow;
+        config["services"].push_back(service);
+    }
+    std::ofstream ofs(path);
+    ofs << config.dump(2);
+    return static_cast<bool>(ofs);
+}
+
+// Calls per second for one worker count, or a negative value on failure.
+double run(const std::string& config_path, std::size_t worker_count)
+{
+    auto server_container = std::make_shared<hakoniwa::pdu::EndpointContainer>(kServerNodeId, kEndpointConfigPath);
+    auto client_container = std::make_shared<hakoniwa::pdu::EndpointContainer>(kClientNodeId, kEndpointConfigPath);
+    if (server_container->initialize() != HAKO_PDU_ERR_OK || client_container->initialize() != HAKO_PDU_ERR_OK) {
+        return -1.0;
+    }
+    RpcServicesServer server(kServerNodeId, "RpcServerEndpointImpl", config_path, 1000);
+    RpcServicesClient client(kClientNodeId, kClientName, config_path, "RpcClientEndpointImpl", 1000);
+    if (!server.initialize_services(server_container) || !client.initialize_services(client_container)) {
+        return -1.0;
+    }
+    if (server_container->start_all() != HAKO_PDU_ERR_OK || client_container->start_all() != HAKO_PDU_ERR_OK) {
+        return -1.0;
+    }
+    if (!server.start_all_services() || !client.start_all_services()) {
+        return -1.0;
+    }
+    const auto ready_deadline = std::chrono::steady_clock::now() + 3s;
+    while (!server_container->is_running_all() || !client_container->is_running_all()) {
+        if (std::chrono::steady_clock::now() >= ready_deadline) {
+            return -1.0;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+
+    RpcServiceExecutor executor(server, worker_count);
+    for (std::size_t i = 0; i < kServices; ++i) {
+        executor.register_handler("Service/Add" + std::to_string(i), [](RpcServicesServer& srv, RpcRequest& request) {
+            HakoRpcServiceServerTemplateType(AddTwoInts) service;
+            HakoCpp_AddTwoIntsRequest body{};
+            service.get_request_body(request, body);
+            std::this_thread::sleep_for(kHandlerTime);
+            HakoCpp_AddTwoIntsResponse response{};
+            response.sum = body.a + body.b;
+            service.reply(srv, request,
+                hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+                hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+                response);
+        });
+    }
+    executor.start();
+
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    std::map<std::string, std::size_t> issued;
+    std::map<std::string, std::size_t> in_flight;
+    std::size_t completed = 0;
+    bool failed = false;
+    const auto started = std::chrono::steady_clock::now();
+    while (completed < kServices * kCallsPerService && !failed) {
+        // Keep every service's window full.
+        for (std::size_t i = 0; i < kServices; ++i) {
+            const std::string name = "Service/Add" + std::to_string(i);
+            while (in_flight[name] < kWindow && issued[name] < kCallsPerService) {
+                if (!service.call(client, name, request_body, 5'000'000)) {
+                    failed = true;
+                    break;
+                }
+                ++in_flight[name];
+                ++issued[name];
+            }
+        }
+        std::string service_name;
+        RpcResponse response;
+        const auto event = client.poll_wait(service_name, response, 5'000'000);
+        if (event != ClientEventType::RESPONSE_IN) {
+            failed = true;
+            break;
+        }
+        --in_flight[service_name];
+        ++completed;
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    executor.stop();
+    server_container->stop_all();
+    client_container->stop_all();
+    server.stop_all_services();
+    client.stop_all_services();
+    server.clear_all_instances();
+    client.clear_all_instances();
+    return failed ? -1.0 : static_cast<double>(completed) / elapsed;
+}
+
+} // namespace
+
+int main()
+{
+    const auto config_path = std::filesystem::temp_directory_path() / "hako_pdu_rpc_executor_benchmark.json";
+    if (!write_service_config(config_path)) {
+        return 1;
+    }
+    std::printf("services=%zu window=%zu calls/service=%zu handler=%lldus\n",
+        kServices, kWindow, kCallsPerService,
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(kHandlerTime).count()));
+    std::printf("%8s %14s\n", "workers", "calls/sec");
+    int status = 0;
+    for (const std::size_t workers : kWorkerCounts) {
+        const double throughput = run(config_path.string(), workers);
+        if (throughput < 0.0) {
+            std::fprintf(stderr, "ERROR: run with %zu workers failed\n", workers);
+            status = 1;
+            break;
+        }
+        std::printf("%8zu %14.1f\n", workers, throughput);
+    }
+    std::filesystem::remove(config_path);
+    return status;
+}
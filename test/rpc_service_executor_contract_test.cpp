@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_service_executor.hpp"
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::PduData;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcResponse;
+using hakoniwa::pdu::rpc::RpcServiceExecutor;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa_rpc_test::RpcRuntime;
+
+// Service/Add and Service/Sum, both with maxInFlight 8.
+constexpr const char* kTwoServiceConfigPath = "configs/service_config_fair.json";
+// Service/Add with maxInFlight 4.
+constexpr const char* kPipelinedConfigPath = "configs/service_config_pipelined.json";
+
+bool send_add(RpcRuntime& runtime, const char* service_name, long long a)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = a;
+    request_body.b = 0;
+    return service.call(runtime.client(), service_name, request_body, 2'000'000);
+}
+
+// Replies with a + b; returns the request's a.
+long long reply_add(RpcServicesServer& server, RpcRequest& request)
+{
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest body{};
+    if (!service.get_request_body(request, body)) {
+        return -1;
+    }
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = body.a + body.b;
+    service.reply(server, request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+        response_body);
+    return body.a;
+}
+
+TEST(RpcServiceExecutorContractTest, SlowHandlerDoesNotStallOtherServices)
+{
+    RpcRuntime runtime(kTwoServiceConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    RpcServiceExecutor executor(runtime.server(), 2);
+    ASSERT_TRUE(executor.register_handler("Service/Add", [](RpcServicesServer& server, RpcRequest& request) {
+        std::this_thread::sleep_for(300ms);
+        reply_add(server, request);
+    }));
+    ASSERT_TRUE(executor.register_handler("Service/Sum", [](RpcServicesServer& server, RpcRequest& request) {
+        reply_add(server, request);
+    }));
+    ASSERT_TRUE(executor.start());
+
+    ASSERT_TRUE(send_add(runtime, "Service/Add", 1));
+    ASSERT_TRUE(send_add(runtime, "Service/Sum", 2));
+
+    std::vector<std::string> order;
+    for (int i = 0; i < 2; ++i) {
+        std::string service_name;
+        RpcResponse response;
+        ASSERT_EQ(runtime.client().poll_wait(service_name, response, 2'000'000), ClientEventType::RESPONSE_IN);
+        order.push_back(service_name);
+    }
+    executor.stop();
+    EXPECT_EQ(order, (std::vector<std::string>{"Service/Sum", "Service/Add"}));
+}
+
+TEST(RpcServiceExecutorContractTest, RequestsOfOneClientRunOneAtATimeInOrder)
+{
+    RpcRuntime runtime(kPipelinedConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    std::mutex seen_mutex;
+    std::vector<long long> seen;
+    std::atomic<int> active{0};
+    std::atomic<int> max_active{0};
+    RpcServiceExecutor executor(runtime.server(), 4);
+    ASSERT_TRUE(executor.register_handler("Service/Add", [&](RpcServicesServer& server, RpcRequest& request) {
+        const int now_active = ++active;
+        int expected = max_active.load();
+        while (now_active > expected && !max_active.compare_exchange_weak(expected, now_active)) {
+        }
+        std::this_thread::sleep_for(20ms);
+        const long long a = reply_add(server, request);
+        {
+            std::lock_guard<std::mutex> lock(seen_mutex);
+            seen.push_back(a);
+        }
+        --active;
+    }));
+    ASSERT_TRUE(executor.start());
+
+    constexpr int kCalls = 4;
+    for (int i = 0; i < kCalls; ++i) {
+        ASSERT_TRUE(send_add(runtime, "Service/Add", i));
+    }
+    for (int i = 0; i < kCalls; ++i) {
+        std::string service_name;
+        RpcResponse response;
+        ASSERT_EQ(runtime.client().poll_wait(service_name, response, 2'000'000), ClientEventType::RESPONSE_IN);
+    }
+    executor.stop();
+
+    EXPECT_EQ(max_active.load(), 1);
+    EXPECT_EQ(seen, (std::vector<long long>{0, 1, 2, 3}));
+}
+
+TEST(RpcServiceExecutorContractTest, RequestWithoutHandlerIsAnsweredWithAnError)
+{
+    RpcRuntime runtime(kTwoServiceConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    RpcServiceExecutor executor(runtime.server(), 1);
+    ASSERT_TRUE(executor.start());
+    EXPECT_FALSE(executor.register_handler("Service/Add", [](RpcServicesServer&, RpcRequest&) {}));
+
+    ASSERT_TRUE(send_add(runtime, "Service/Add", 1));
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_EQ(runtime.client().poll_wait(service_name, response, 2'000'000), ClientEventType::RESPONSE_IN);
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_ERROR);
+    executor.stop();
+}
+
+TEST(RpcServiceExecutorContractTest, ThrowingHandlerIsAnsweredWithAnError)
+{
+    RpcRuntime runtime(kTwoServiceConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    RpcServiceExecutor executor(runtime.server(), 1);
+    ASSERT_TRUE(executor.register_handler("Service/Add", [](RpcServicesServer&, RpcRequest&) {
+        throw std::runtime_error("handler failed");
+    }));
+    ASSERT_TRUE(executor.start());
+
+    ASSERT_TRUE(send_add(runtime, "Service/Add", 1));
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_EQ(runtime.client().poll_wait(service_name, response, 2'000'000), ClientEventType::RESPONSE_IN);
+    EXPECT_EQ(response.header.status, hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_ERROR);
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_ERROR);
+
+    // The worker survives and serves the next request.
+    ASSERT_TRUE(send_add(runtime, "Service/Add", 2));
+    ASSERT_EQ(runtime.client().poll_wait(service_name, response, 2'000'000), ClientEventType::RESPONSE_IN);
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_ERROR);
+    executor.stop();
+}
+
+TEST(RpcServiceExecutorContractTest, CancelReachesARunningHandler)
+{
+    RpcRuntime runtime(kTwoServiceConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    std::atomic<bool> started{false};
+    std::atomic<bool> saw_cancel{false};
+    RpcServiceExecutor executor(runtime.server(), 1);
+    ASSERT_TRUE(executor.register_handler("Service/Add", [&](RpcServicesServer& server, RpcRequest& request) {
+        started = true;
+        const auto deadline = std::chrono::steady_clock::now() + 2s;
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (executor.cancel_requested(request)) {
+                saw_cancel = true;
+                return;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+        reply_add(server, request);
+    }));
+    ASSERT_TRUE(executor.start());
+
+    PduData pdu;
+    ASSERT_TRUE(runtime.client().create_request_buffer("Service/Add", pdu));
+    Hako_uint32 request_id = 0;
+    ASSERT_TRUE(runtime.client().call("Service/Add", pdu, 5'000'000, request_id));
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (!started && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_TRUE(started);
+    ASSERT_TRUE(runtime.client().send_cancel_request("Service/Add", request_id));
+
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_EQ(runtime.client().poll_wait(service_name, response, 1'000'000), ClientEventType::RESPONSE_CANCEL);
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_CANCELED);
+    executor.stop();
+    EXPECT_TRUE(saw_cancel);
+}
+
+} // namespace
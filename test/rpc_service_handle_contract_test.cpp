@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::PduData;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcResponse;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa::pdu::rpc::ServiceHandle;
+using hakoniwa_rpc_test::RpcRuntime;
+
+// Service/Add and Service/Sum, both AddTwoInts.
+constexpr const char* kConfigPath = "configs/service_config_fair.json";
+
+using AddService = HakoRpcServiceServerTemplateType(AddTwoInts);
+
+TEST(RpcServiceHandleContractTest, CallAndReplyThroughHandles)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    const ServiceHandle client_add = runtime.client().get_service("Service/Add");
+    const ServiceHandle client_sum = runtime.client().get_service("Service/Sum");
+    const ServiceHandle server_sum = runtime.server().get_service("Service/Sum");
+    ASSERT_TRUE(client_add.valid());
+    ASSERT_TRUE(client_sum.valid());
+    ASSERT_TRUE(server_sum.valid());
+    EXPECT_NE(client_add, client_sum);
+
+    AddService service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = 20;
+    request_body.b = 22;
+    ASSERT_TRUE(service.call(runtime.client(), client_sum, request_body, 2'000'000));
+
+    ServiceHandle polled;
+    RpcRequest request;
+    ASSERT_EQ(runtime.server().poll_wait(polled, request, 2'000'000), ServerEventType::REQUEST_IN);
+    EXPECT_EQ(polled, server_sum);
+    EXPECT_EQ(request.header.service_name, "Service/Sum");
+    HakoCpp_AddTwoIntsRequest received{};
+    ASSERT_TRUE(service.get_request_body(request, received));
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = received.a + received.b;
+    ASSERT_TRUE(service.reply(runtime.server(), polled, request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK,
+        response_body));
+
+    ServiceHandle responded;
+    RpcResponse response;
+    ASSERT_EQ(runtime.client().poll_wait(responded, response, 2'000'000), ClientEventType::RESPONSE_IN);
+    EXPECT_EQ(responded, client_sum);
+    HakoCpp_AddTwoIntsResponse result{};
+    ASSERT_TRUE(service.get_response_body(response, result));
+    EXPECT_EQ(result.sum, 42);
+}
+
+TEST(RpcServiceHandleContractTest, CancelThroughHandleReachesTheServer)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    const ServiceHandle client_add = runtime.client().get_service("Service/Add");
+    PduData pdu;
+    ASSERT_TRUE(runtime.client().create_request_buffer(client_add, pdu));
+    Hako_uint32 request_id = 0;
+    ASSERT_TRUE(runtime.client().call(client_add, pdu, 2'000'000, request_id));
+
+    ServiceHandle polled;
+    RpcRequest request;
+    ASSERT_EQ(runtime.server().poll_wait(polled, request, 2'000'000), ServerEventType::REQUEST_IN);
+    ASSERT_TRUE(runtime.client().send_cancel_request(client_add, request_id));
+    ASSERT_EQ(runtime.server().poll_wait(polled, request, 2'000'000), ServerEventType::REQUEST_CANCEL);
+    EXPECT_EQ(polled, runtime.server().get_service("Service/Add"));
+    EXPECT_EQ(request.header.request_id, request_id);
+
+    PduData cancel_response;
+    runtime.server().create_reply_buffer(polled, request.header,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_CANCELED,
+        cancel_response);
+    runtime.server().send_cancel_reply(polled, request.header, cancel_response);
+
+    ServiceHandle responded;
+    RpcResponse response;
+    ASSERT_EQ(runtime.client().poll_wait(responded, response, 2'000'000), ClientEventType::RESPONSE_CANCEL);
+    EXPECT_EQ(responded, client_add);
+}
+
+TEST(RpcServiceHandleContractTest, UnknownOrForeignHandlesAreRejected)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    EXPECT_FALSE(runtime.client().get_service("Service/Missing").valid());
+    EXPECT_FALSE(runtime.server().get_service("Service/Missing").valid());
+
+    PduData pdu;
+    ASSERT_TRUE(runtime.client().create_request_buffer("Service/Add", pdu));
+    EXPECT_FALSE(runtime.client().call(ServiceHandle{}, pdu, 1'000'000));
+    // A server handle has the same slot numbering but belongs to the server.
+    const ServiceHandle server_add = runtime.server().get_service("Service/Add");
+    ASSERT_TRUE(server_add.valid());
+    EXPECT_FALSE(runtime.client().call(server_add, pdu, 1'000'000));
+    EXPECT_FALSE(runtime.client().send_cancel_request(server_add));
+    PduData other;
+    EXPECT_FALSE(runtime.client().create_request_buffer(ServiceHandle{}, other));
+}
+
+} // namespace
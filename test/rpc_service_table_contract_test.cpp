@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_service_table.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::RpcClientInfo;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcResponse;
+using hakoniwa::pdu::rpc::RpcServiceInfo;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa::pdu::rpc::TypedRpcServer;
+using hakoniwa_rpc_test::RpcRuntime;
+
+// Service/Add and Service/Sum, both AddTwoInts.
+constexpr const char* kConfigPath = "configs/service_config_fair.json";
+
+// configs/service_config_fair.json in the form generate_service_config.py
+// --cpp-header emits.
+inline constexpr RpcClientInfo ADD_CLIENTS[] = {
+    {"TestClient", 1, 2},
+};
+
+inline constexpr RpcClientInfo SUM_CLIENTS[] = {
+    {"TestClient", 1, 2},
+};
+
+struct ServiceTable {
+    static constexpr std::size_t ADD = 0;
+    static constexpr std::size_t SUM = 1;
+    static constexpr RpcServiceInfo services[] = {
+        {"Service/Add", "hako_srv_msgs/AddTwoInts", 1, 296, 0, 288, 0, ADD_CLIENTS},
+        {"Service/Sum", "hako_srv_msgs/AddTwoInts", 1, 296, 0, 288, 0, SUM_CLIENTS},
+    };
+    using Helpers = std::tuple<
+        HakoRpcServiceServerTemplateType(AddTwoInts),
+        HakoRpcServiceServerTemplateType(AddTwoInts)>;
+};
+
+using Server = TypedRpcServer<ServiceTable>;
+
+static_assert(Server::SERVICE_COUNT == 2);
+static_assert(Server::index_of("Service/Add") == ServiceTable::ADD);
+static_assert(Server::index_of("Service/Sum") == ServiceTable::SUM);
+static_assert(Server::index_of("Service/Missing") == Server::SERVICE_COUNT);
+static_assert(std::is_same_v<Server::RequestBody<ServiceTable::ADD>, HakoCpp_AddTwoIntsRequest>);
+static_assert(std::is_same_v<Server::ResponseBody<ServiceTable::SUM>, HakoCpp_AddTwoIntsResponse>);
+
+// The same services, but generated from a config that has since changed.
+inline constexpr RpcClientInfo MOVED_CLIENTS[] = {
+    {"TestClient", 5, 6},
+};
+
+struct StaleTable {
+    static constexpr RpcServiceInfo services[] = {
+        {"Service/Add", "hako_srv_msgs/AddTwoInts", 1, 312, 0, 288, 0, ADD_CLIENTS},
+        {"Service/Sum", "hako_srv_msgs/AddTwoInts", 1, 296, 0, 288, 0, MOVED_CLIENTS},
+    };
+    using Helpers = std::tuple<
+        HakoRpcServiceServerTemplateType(AddTwoInts),
+        HakoRpcServiceServerTemplateType(AddTwoInts)>;
+};
+
+struct MissingServiceTable {
+    static constexpr RpcServiceInfo services[] = {
+        {"Service/Add", "hako_srv_msgs/AddTwoInts", 1, 296, 0, 288, 0, ADD_CLIENTS},
+        {"Service/Missing", "hako_srv_msgs/AddTwoInts", 1, 296, 0, 288, 0, ADD_CLIENTS},
+    };
+    using Helpers = std::tuple<
+        HakoRpcServiceServerTemplateType(AddTwoInts),
+        HakoRpcServiceServerTemplateType(AddTwoInts)>;
+};
+
+using AddService = HakoRpcServiceServerTemplateType(AddTwoInts);
+
+bool send_add(RpcRuntime& runtime, const char* service_name, long long a, long long b)
+{
+    AddService service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = a;
+    request_body.b = b;
+    return service.call(runtime.client(), service_name, request_body, 2'000'000);
+}
+
+// Serves requests until the client has a response, and returns it.
+template <typename TypedServer>
+bool serve_until_response(TypedServer& server, RpcRuntime& runtime, std::string& service_name, RpcResponse& response)
+{
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (std::chrono::steady_clock::now() < deadline) {
+        server.poll_wait(10'000);
+        if (runtime.client().poll(service_name, response) == ClientEventType::RESPONSE_IN) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST(RpcServiceTableContractTest, RequestsRunTheHandlerOfTheirServiceIndex)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    Server server(runtime.server());
+    ASSERT_TRUE(server.resolve());
+    server.set_handler<ServiceTable::ADD>([](const HakoCpp_AddTwoIntsRequest& request, HakoCpp_AddTwoIntsResponse& response) {
+        response.sum = request.a + request.b;
+        return true;
+    });
+    server.set_handler<ServiceTable::SUM>([](const HakoCpp_AddTwoIntsRequest& request, HakoCpp_AddTwoIntsResponse& response) {
+        response.sum = 100 + request.a + request.b;
+        return true;
+    });
+
+    ASSERT_TRUE(send_add(runtime, "Service/Add", 2, 3));
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_TRUE(serve_until_response(server, runtime, service_name, response));
+    EXPECT_EQ(service_name, "Service/Add");
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK);
+    AddService service;
+    HakoCpp_AddTwoIntsResponse body{};
+    ASSERT_TRUE(service.get_response_body(response, body));
+    EXPECT_EQ(body.sum, 5);
+
+    ASSERT_TRUE(send_add(runtime, "Service/Sum", 2, 3));
+    ASSERT_TRUE(serve_until_response(server, runtime, service_name, response));
+    EXPECT_EQ(service_name, "Service/Sum");
+    ASSERT_TRUE(service.get_response_body(response, body));
+    EXPECT_EQ(body.sum, 105);
+}
+
+TEST(RpcServiceTableContractTest, FailedOrMissingHandlersAreAnsweredWithAnError)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    Server server(runtime.server());
+    server.set_handler<ServiceTable::ADD>([](const HakoCpp_AddTwoIntsRequest&, HakoCpp_AddTwoIntsResponse&) {
+        return false;
+    });
+
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_TRUE(send_add(runtime, "Service/Add", 1, 1));
+    ASSERT_TRUE(serve_until_response(server, runtime, service_name, response));
+    EXPECT_EQ(response.header.status, hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_ERROR);
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_ERROR);
+
+    ASSERT_TRUE(send_add(runtime, "Service/Sum", 1, 1));
+    ASSERT_TRUE(serve_until_response(server, runtime, service_name, response));
+    EXPECT_EQ(service_name, "Service/Sum");
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_ERROR);
+}
+
+TEST(RpcServiceTableContractTest, TableOfAnotherConfigIsRejected)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    // Service/Add has another pduSize and Service/Sum other channels.
+    TypedRpcServer<StaleTable> stale(runtime.server());
+    EXPECT_FALSE(stale.resolve());
+    TypedRpcServer<MissingServiceTable> missing(runtime.server());
+    EXPECT_FALSE(missing.resolve());
+
+    // A service that does not match its entry is answered with an error
+    // instead of reaching the handler.
+    bool handled = false;
+    stale.set_handler<0>([&handled](const HakoCpp_AddTwoIntsRequest&, HakoCpp_AddTwoIntsResponse&) {
+        handled = true;
+        return true;
+    });
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_TRUE(send_add(runtime, "Service/Add", 1, 1));
+    ASSERT_TRUE(serve_until_response(stale, runtime, service_name, response));
+    EXPECT_FALSE(handled);
+    EXPECT_EQ(response.header.status, hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_ERROR);
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_ERROR);
+
+    // The services that do match are still served.
+    missing.set_handler<0>([](const HakoCpp_AddTwoIntsRequest& request, HakoCpp_AddTwoIntsResponse& reply) {
+        reply.sum = request.a + request.b;
+        return true;
+    });
+    ASSERT_TRUE(send_add(runtime, "Service/Add", 2, 3));
+    ASSERT_TRUE(serve_until_response(missing, runtime, service_name, response));
+    EXPECT_EQ(response.header.result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK);
+}
+
+} // namespace
@@ -0,0 +1,137 @@
+#pragma once
+
+// Start-up fixture shared by the native RPC contract tests: one server and
+// one client on the in-process endpoints of configs/endpoints.json.
+
+#include "hakoniwa/pdu/endpoint_container.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace hakoniwa_rpc_test {
+
+inline constexpr const char* kEndpointConfigPath = "configs/endpoints.json";
+inline constexpr const char* kServerNodeId = "server_node";
+inline constexpr const char* kClientNodeId = "client_node";
+inline constexpr const char* kClientName = "TestClient";
+
+class RpcRuntime {
+public:
+    // The client reads client_config_path when given, else the server's config.
+    explicit RpcRuntime(const char* config_path, const char* client_config_path = nullptr)
+        : server_endpoint_(std::make_shared<hakoniwa::pdu::EndpointContainer>(
+              kServerNodeId, kEndpointConfigPath))
+        , client_endpoint_(std::make_shared<hakoniwa::pdu::EndpointContainer>(
+              kClientNodeId, kEndpointConfigPath))
+        , server_(kServerNodeId, "RpcServerEndpointImpl", config_path, 1000)
+        , client_(kClientNodeId, kClientName,
+              client_config_path != nullptr ? client_config_path : config_path,
+              "RpcClientEndpointImpl", 1000)
+    {
+    }
+
+    ~RpcRuntime()
+    {
+        stop();
+    }
+
+    RpcRuntime(const RpcRuntime&) = delete;
+    RpcRuntime& operator=(const RpcRuntime&) = delete;
+
+    bool start()
+    {
+        using namespace std::chrono_literals;
+        if (server_endpoint_->initialize() != HAKO_PDU_ERR_OK ||
+            client_endpoint_->initialize() != HAKO_PDU_ERR_OK) {
+            return false;
+        }
+        if (!server_.initialize_services(server_endpoint_) ||
+            !client_.initialize_services(client_endpoint_)) {
+            return false;
+        }
+        if (server_endpoint_->start_all() != HAKO_PDU_ERR_OK ||
+            client_endpoint_->start_all() != HAKO_PDU_ERR_OK) {
+            return false;
+        }
+        if (!server_.start_all_services() || !client_.start_all_services()) {
+            return false;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + 3s;
+        while (!server_endpoint_->is_running_all() || !client_endpoint_->is_running_all()) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+        started_ = true;
+        return true;
+    }
+
+    void stop()
+    {
+        if (!started_) {
+            return;
+        }
+        server_endpoint_->stop_all();
+        client_endpoint_->stop_all();
+        server_.stop_all_services();
+        client_.stop_all_services();
+        server_.clear_all_instances();
+        client_.clear_all_instances();
+        started_ = false;
+    }
+
+    hakoniwa::pdu::rpc::ServerEventType wait_server_event(
+        hakoniwa::pdu::rpc::RpcRequest& request,
+        std::chrono::milliseconds timeout = std::chrono::seconds(2))
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            const auto event = server_.poll(request);
+            if (event != hakoniwa::pdu::rpc::ServerEventType::NONE) {
+                return event;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return hakoniwa::pdu::rpc::ServerEventType::NONE;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    hakoniwa::pdu::rpc::ClientEventType wait_client_event(
+        std::string& service_name,
+        hakoniwa::pdu::rpc::RpcResponse& response,
+        std::chrono::milliseconds timeout = std::chrono::seconds(2))
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            const auto event = client_.poll(service_name, response);
+            if (event != hakoniwa::pdu::rpc::ClientEventType::NONE) {
+                return event;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return hakoniwa::pdu::rpc::ClientEventType::NONE;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // The client's transport, e.g. to cut it.
+    hakoniwa::pdu::EndpointContainer& client_endpoint() { return *client_endpoint_; }
+    hakoniwa::pdu::rpc::RpcServicesServer& server() { return server_; }
+    hakoniwa::pdu::rpc::RpcServicesClient& client() { return client_; }
+
+private:
+    std::shared_ptr<hakoniwa::pdu::EndpointContainer> server_endpoint_;
+    std::shared_ptr<hakoniwa::pdu::EndpointContainer> client_endpoint_;
+    hakoniwa::pdu::rpc::RpcServicesServer server_;
+    hakoniwa::pdu::rpc::RpcServicesClient client_;
+    bool started_ = false;
+};
+
+} // namespace hakoniwa_rpc_test
@@ -1,13 +1,19 @@
 #include <gtest/gtest.h>
 
 #include "hakoniwa/pdu/endpoint_container.hpp"
+#include "hakoniwa/pdu/rpc/rpc_client_endpoint_impl.hpp"
 #include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
 #include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
 #include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
 #include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
 #include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "hakoniwa/time_source/time_source_factory.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <nlohmann/json.hpp>
 
 #include <chrono>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <thread>
@@ -16,126 +22,21 @@ namespace {
 
 using namespace std::chrono_literals;
 using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::PduData;
+using hakoniwa::pdu::rpc::RpcClientEndpointImpl;
 using hakoniwa::pdu::rpc::RpcRequest;
 using hakoniwa::pdu::rpc::RpcResponse;
 using hakoniwa::pdu::rpc::RpcServicesClient;
 using hakoniwa::pdu::rpc::RpcServicesServer;
 using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa_rpc_test::RpcRuntime;
 
 constexpr const char* kConfigPath = "configs/service_config.json";
-constexpr const char* kEndpointConfigPath = "configs/endpoints.json";
-constexpr const char* kServerNodeId = "server_node";
-constexpr const char* kClientNodeId = "client_node";
-constexpr const char* kClientName = "TestClient";
 constexpr const char* kServiceName = "Service/Add";
 
-class RpcRuntime {
-public:
-    RpcRuntime()
-        : server_endpoint_(std::make_shared<hakoniwa::pdu::EndpointContainer>(
-              kServerNodeId, kEndpointConfigPath))
-        , client_endpoint_(std::make_shared<hakoniwa::pdu::EndpointContainer>(
-              kClientNodeId, kEndpointConfigPath))
-        , server_(kServerNodeId, "RpcServerEndpointImpl", kConfigPath, 1000)
-        , client_(kClientNodeId, kClientName, kConfigPath, "RpcClientEndpointImpl", 1000)
-    {
-    }
-
-    ~RpcRuntime()
-    {
-        stop();
-    }
-
-    bool start()
-    {
-        if (server_endpoint_->initialize() != HAKO_PDU_ERR_OK ||
-            client_endpoint_->initialize() != HAKO_PDU_ERR_OK) {
-            return false;
-        }
-        if (!server_.initialize_services(server_endpoint_) ||
-            !client_.initialize_services(client_endpoint_)) {
-            return false;
-        }
-        if (server_endpoint_->start_all() != HAKO_PDU_ERR_OK ||
-            client_endpoint_->start_all() != HAKO_PDU_ERR_OK) {
-            return false;
-        }
-        if (!server_.start_all_services() || !client_.start_all_services()) {
-            return false;
-        }
-
-        const auto deadline = std::chrono::steady_clock::now() + 3s;
-        while (!server_endpoint_->is_running_all() || !client_endpoint_->is_running_all()) {
-            if (std::chrono::steady_clock::now() >= deadline) {
-                return false;
-            }
-            std::this_thread::sleep_for(1ms);
-        }
-        started_ = true;
-        return true;
-    }
-
-    void stop()
-    {
-        if (!started_) {
-            return;
-        }
-        server_endpoint_->stop_all();
-        client_endpoint_->stop_all();
-        server_.stop_all_services();
-        client_.stop_all_services();
-        server_.clear_all_instances();
-        client_.clear_all_instances();
-        started_ = false;
-    }
-
-    ServerEventType wait_server_event(RpcRequest& request, std::chrono::milliseconds timeout = 2s)
-    {
-        const auto deadline = std::chrono::steady_clock::now() + timeout;
-        for (;;) {
-            const auto event = server_.poll(request);
-            if (event != ServerEventType::NONE) {
-                return event;
-            }
-            if (std::chrono::steady_clock::now() >= deadline) {
-                return ServerEventType::NONE;
-            }
-            std::this_thread::sleep_for(1ms);
-        }
-    }
-
-    ClientEventType wait_client_event(
-        std::string& service_name,
-        RpcResponse& response,
-        std::chrono::milliseconds timeout = 2s)
-    {
-        const auto deadline = std::chrono::steady_clock::now() + timeout;
-        for (;;) {
-            const auto event = client_.poll(service_name, response);
-            if (event != ClientEventType::NONE) {
-                return event;
-            }
-            if (std::chrono::steady_clock::now() >= deadline) {
-                return ClientEventType::NONE;
-            }
-            std::this_thread::sleep_for(1ms);
-        }
-    }
-
-    RpcServicesServer& server() { return server_; }
-    RpcServicesClient& client() { return client_; }
-
-private:
-    std::shared_ptr<hakoniwa::pdu::EndpointContainer> server_endpoint_;
-    std::shared_ptr<hakoniwa::pdu::EndpointContainer> client_endpoint_;
-    RpcServicesServer server_;
-    RpcServicesClient client_;
-    bool started_ = false;
-};
-
 TEST(RpcTimeoutCancelContractTest, TimeoutRequiresExplicitCancelAndTerminalCancelCompletion)
 {
-    RpcRuntime runtime;
+    RpcRuntime runtime(kConfigPath);
     ASSERT_TRUE(runtime.start());
 
     HakoRpcServiceServerTemplateType(AddTwoInts) service;
@@ -204,4 +105,41 @@ TEST(RpcTimeoutCancelContractTest, TimeoutRequiresExplicitCancelAndTerminalCance
     EXPECT_EQ(parsed_response.sum, 15);
 }
 
+TEST(RpcTimeoutCancelContractTest, EndpointWithoutTimerWheelStillTimesOut)
+{
+    std::ifstream ifs(kConfigPath);
+    ASSERT_TRUE(ifs.is_open());
+    const nlohmann::json service_config = nlohmann::json::parse(ifs);
+
+    auto container = std::make_shared<hakoniwa::pdu::EndpointContainer>(
+        hakoniwa_rpc_test::kClientNodeId, hakoniwa_rpc_test::kEndpointConfigPath);
+    ASSERT_EQ(container->initialize(), HAKO_PDU_ERR_OK);
+    // Used on its own, without the timer wheel RpcServicesClient provides.
+    auto endpoint = std::make_shared<RpcClientEndpointImpl>(kServiceName, hakoniwa_rpc_test::kClientName, 1000,
+        container->ref("client_ep_id"), hakoniwa::time_source::create_time_source("real", 1000));
+    ASSERT_TRUE(endpoint->initialize(service_config["services"][0], service_config.value("pduMetaDataSize", 24)));
+    ASSERT_EQ(container->start_all(), HAKO_PDU_ERR_OK);
+
+    PduData pdu;
+    endpoint->create_request_buffer(hakoniwa::pdu::rpc::HAKO_SERVICE_OPERATION_CODE_REQUEST, false, pdu);
+    Hako_uint32 request_id = 0;
+    ASSERT_TRUE(endpoint->call(pdu, 20'000, request_id));
+
+    RpcResponse response;
+    ClientEventType event = ClientEventType::NONE;
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (event == ClientEventType::NONE && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+        event = endpoint->poll(response);
+    }
+    ASSERT_EQ(event, ClientEventType::RESPONSE_TIMEOUT);
+    EXPECT_EQ(response.header.request_id, request_id);
+    // Reported once; the call stays in flight until it is cancelled.
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(endpoint->poll(response), ClientEventType::NONE);
+    EXPECT_TRUE(endpoint->has_in_flight());
+
+    container->stop_all();
+}
+
 } // namespace
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_timer_wheel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+using hakoniwa::pdu::rpc::RpcTimerWheel;
+
+constexpr uint64_t kTickUsec = 1000;
+// Virtual time, far from 0 so that nothing lines up with a wheel turn.
+constexpr uint64_t kStartUsec = 123'456'789;
+
+std::vector<uint32_t> advance_ids(RpcTimerWheel& wheel, uint64_t now_usec)
+{
+    std::vector<RpcTimerWheel::Expired> expired;
+    wheel.advance(now_usec, expired);
+    std::vector<uint32_t> ids;
+    for (const auto& timer : expired) {
+        ids.push_back(timer.id);
+    }
+    return ids;
+}
+
+TEST(RpcTimerWheelContractTest, TimerFiresOnceAtItsDeadline)
+{
+    RpcTimerWheel wheel(kTickUsec);
+    wheel.schedule(kStartUsec, kStartUsec + 50'000, 3, 7);
+    EXPECT_TRUE(advance_ids(wheel, kStartUsec + 49'000).empty());
+
+    std::vector<RpcTimerWheel::Expired> expired;
+    wheel.advance(kStartUsec + 51'000, expired);
+    ASSERT_EQ(expired.size(), 1U);
+    EXPECT_EQ(expired[0].owner, 3U);
+    EXPECT_EQ(expired[0].id, 7U);
+
+    EXPECT_TRUE(advance_ids(wheel, kStartUsec + 60'000).empty());
+    EXPECT_EQ(wheel.size(), 0U);
+}
+
+TEST(RpcTimerWheelContractTest, CancelledTimerDoesNotFire)
+{
+    RpcTimerWheel wheel(kTickUsec);
+    const auto first = wheel.schedule(kStartUsec, kStartUsec + 10'000, 0, 1);
+    wheel.schedule(kStartUsec, kStartUsec + 10'000, 0, 2);
+    wheel.cancel(first);
+    // Cancelling again, or after the timer is gone, has no effect.
+    wheel.cancel(first);
+    EXPECT_EQ(advance_ids(wheel, kStartUsec + 20'000), (std::vector<uint32_t>{2}));
+    EXPECT_EQ(wheel.size(), 0U);
+}
+
+TEST(RpcTimerWheelContractTest, TimersOnEveryLevelFireOnTime)
+{
+    RpcTimerWheel wheel(kTickUsec);
+    // Deadlines on every level of the wheel, and one past its span.
+    const std::vector<uint64_t> offsets_usec{
+        5'000, 63'000, 64'000, 4'000'000, 300'000'000, 20'000'000'000, 40'000'000'000};
+    for (uint32_t i = 0; i < offsets_usec.size(); ++i) {
+        wheel.schedule(kStartUsec, kStartUsec + offsets_usec[i], 0, i);
+    }
+    // Polled about once a second; timers due within one step fire together.
+    constexpr uint64_t kStepUsec = 997'000;
+    std::vector<uint32_t> fired;
+    for (uint64_t now = kStartUsec; now < kStartUsec + offsets_usec.back() + kStepUsec + kTickUsec; now += kStepUsec) {
+        for (const auto id : advance_ids(wheel, now)) {
+            EXPECT_GE(now, kStartUsec + offsets_usec[id]) << "timer " << id << " fired early";
+            EXPECT_LT(now, kStartUsec + offsets_usec[id] + kStepUsec + kTickUsec) << "timer " << id << " fired late";
+            fired.push_back(id);
+        }
+    }
+    std::sort(fired.begin(), fired.end());
+    EXPECT_EQ(fired, (std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6}));
+}
+
+TEST(RpcTimerWheelContractTest, ReportsTimeUntilTheNextTimer)
+{
+    RpcTimerWheel wheel(kTickUsec);
+    EXPECT_EQ(wheel.usec_until_next(kStartUsec), UINT64_MAX);
+
+    wheel.schedule(kStartUsec, kStartUsec + 10'000, 0, 1);
+    const uint64_t wait_usec = wheel.usec_until_next(kStartUsec);
+    EXPECT_GT(wait_usec, 0U);
+    EXPECT_LE(wait_usec, 10'000U + kTickUsec);
+
+    // Already due when scheduled: fires on the next advance without a tick.
+    wheel.schedule(kStartUsec, kStartUsec - 5'000, 0, 2);
+    EXPECT_EQ(wheel.usec_until_next(kStartUsec), 0U);
+    EXPECT_EQ(advance_ids(wheel, kStartUsec), (std::vector<uint32_t>{2}));
+}
+
+} // namespace
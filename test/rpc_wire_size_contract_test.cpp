@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include "hakoniwa/pdu/rpc/rpc_packet.hpp"
+#include "hakoniwa/pdu/rpc/rpc_service_helper.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_client.hpp"
+#include "hakoniwa/pdu/rpc/rpc_services_server.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"
+#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsResponsePacket.hpp"
+#include "rpc_test_runtime.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using hakoniwa::pdu::rpc::ClientEventType;
+using hakoniwa::pdu::rpc::RpcRequest;
+using hakoniwa::pdu::rpc::RpcResponse;
+using hakoniwa::pdu::rpc::RpcServicesClient;
+using hakoniwa::pdu::rpc::RpcServicesServer;
+using hakoniwa::pdu::rpc::ServerEventType;
+using hakoniwa_rpc_test::RpcRuntime;
+
+constexpr const char* kConfigPath = "configs/service_config_large_heap.json";
+constexpr const char* kServiceName = "Service/Add";
+
+TEST(RpcWireSizeContractTest, PacketsAreTrimmedToTheirUsedSize)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    // The configured request size includes the whole 4 KiB client heap.
+    std::size_t configured_request_size = 0;
+    EXPECT_FALSE(runtime.client().create_request_buffer(kServiceName, nullptr, 0, configured_request_size));
+    ASSERT_GT(configured_request_size, 4096U);
+
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = 20;
+    request_body.b = 22;
+    hakoniwa::pdu::rpc::PduData request_pdu;
+    ASSERT_TRUE(service.set_request_body(runtime.client(), kServiceName, request_body, request_pdu));
+    ASSERT_TRUE(runtime.client().call(kServiceName, request_pdu, 1'000'000));
+
+    RpcRequest request;
+    ASSERT_EQ(runtime.wait_server_event(request), ServerEventType::REQUEST_IN);
+    EXPECT_LT(request.pdu.size(), configured_request_size);
+    EXPECT_EQ(request.pdu.size(), hakoniwa::pdu::rpc::rpc_packet_wire_size(request.pdu.data(), request.pdu.size()));
+    HakoCpp_AddTwoIntsRequest parsed_request{};
+    ASSERT_TRUE(service.get_request_body(request, parsed_request));
+    EXPECT_EQ(parsed_request.a, 20);
+    EXPECT_EQ(parsed_request.b, 22);
+
+    hakoniwa::pdu::rpc::PduData configured_reply;
+    runtime.server().create_reply_buffer(request.header,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK, configured_reply);
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = parsed_request.a + parsed_request.b;
+    ASSERT_TRUE(service.reply(runtime.server(), request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK, response_body));
+
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_IN);
+    EXPECT_LT(response.pdu.size(), configured_reply.size());
+    HakoCpp_AddTwoIntsResponse parsed_response{};
+    ASSERT_TRUE(service.get_response_body(response, parsed_response));
+    EXPECT_EQ(parsed_response.sum, 42);
+}
+
+TEST(RpcWireSizeContractTest, HeaderViewReadsShortPacketsInPlace)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    hakoniwa::pdu::rpc::PduData request_pdu;
+    ASSERT_TRUE(runtime.client().create_request_buffer(kServiceName, request_pdu));
+    const auto wire_size = hakoniwa::pdu::rpc::rpc_packet_wire_size(request_pdu.data(), request_pdu.size());
+    ASSERT_LT(wire_size, request_pdu.size());
+    request_pdu.resize(wire_size);
+
+    hako::pdu::PduConvertor<HakoCpp_ServiceRequestHeader, hako::pdu::msgs::hako_srv_msgs::ServiceRequestHeader> convertor;
+    HakoCpp_ServiceRequestHeader converted;
+    ASSERT_TRUE(convertor.pdu2cpp(reinterpret_cast<char*>(request_pdu.data()), converted));
+
+    hakoniwa::pdu::rpc::RpcRequestHeaderView view;
+    ASSERT_TRUE(view.bind(request_pdu.data(), request_pdu.size()));
+    EXPECT_EQ(view.request_id(), converted.request_id);
+    EXPECT_EQ(view.opcode(), converted.opcode);
+    EXPECT_EQ(view.service_name(), converted.service_name);
+    EXPECT_EQ(view.client_name(), converted.client_name);
+
+    HakoCpp_ServiceRequestHeader copied;
+    view.copy_to(copied);
+    EXPECT_EQ(copied.request_id, converted.request_id);
+    EXPECT_EQ(copied.client_name, converted.client_name);
+
+    // A packet cut inside its used prefix no longer carries a whole header.
+    EXPECT_FALSE(view.bind(request_pdu.data(), wire_size - 1));
+    EXPECT_FALSE(view.valid());
+}
+
+TEST(RpcWireSizeContractTest, InPlaceBodyEncodingMatchesRoundTrip)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    // The helper without C packet types decodes and re-encodes the packet.
+    hakoniwa::pdu::rpc::HakoRpcAssetServiceServer<
+        HakoCpp_AddTwoIntsRequestPacket,
+        HakoCpp_AddTwoIntsResponsePacket,
+        HakoCpp_AddTwoIntsRequest,
+        HakoCpp_AddTwoIntsResponse,
+        HAKO_RPC_SERVICE_SERVER_TYPE(AddTwoIntsRequestPacket),
+        HAKO_RPC_SERVICE_SERVER_TYPE(AddTwoIntsResponsePacket)> round_trip;
+    HakoRpcServiceServerTemplateType(AddTwoInts) in_place;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = 20;
+    request_body.b = 22;
+    hakoniwa::pdu::rpc::PduData round_trip_pdu;
+    hakoniwa::pdu::rpc::PduData in_place_pdu;
+    ASSERT_TRUE(round_trip.set_request_body(runtime.client(), kServiceName, request_body, round_trip_pdu));
+    ASSERT_TRUE(in_place.set_request_body(runtime.client(), kServiceName, request_body, in_place_pdu));
+    EXPECT_EQ(hakoniwa::pdu::rpc::rpc_packet_wire_size(in_place_pdu.data(), in_place_pdu.size()),
+        hakoniwa::pdu::rpc::rpc_packet_wire_size(round_trip_pdu.data(), round_trip_pdu.size()));
+
+    hako::pdu::msgs::hako_srv_msgs::AddTwoIntsRequestPacket convertor;
+    HakoCpp_AddTwoIntsRequestPacket round_trip_packet;
+    HakoCpp_AddTwoIntsRequestPacket in_place_packet;
+    ASSERT_TRUE(convertor.pdu2cpp(reinterpret_cast<char*>(round_trip_pdu.data()), round_trip_packet));
+    ASSERT_TRUE(convertor.pdu2cpp(reinterpret_cast<char*>(in_place_pdu.data()), in_place_packet));
+    EXPECT_EQ(in_place_packet.header.request_id, round_trip_packet.header.request_id + 1);
+    EXPECT_EQ(in_place_packet.header.service_name, round_trip_packet.header.service_name);
+    EXPECT_EQ(in_place_packet.header.client_name, round_trip_packet.header.client_name);
+    EXPECT_EQ(in_place_packet.header.opcode, round_trip_packet.header.opcode);
+    EXPECT_EQ(in_place_packet.body.a, 20);
+    EXPECT_EQ(in_place_packet.body.b, 22);
+}
+
+TEST(RpcWireSizeContractTest, PacketViewReadsBodiesInPlace)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    request_body.a = 20;
+    request_body.b = 22;
+    ASSERT_TRUE(service.call(runtime.client(), kServiceName, request_body, 1'000'000));
+
+    RpcRequest request;
+    ASSERT_EQ(runtime.wait_server_event(request), ServerEventType::REQUEST_IN);
+    decltype(service)::RequestView request_view;
+    ASSERT_TRUE(service.get_request_view(request, request_view));
+    EXPECT_EQ(request_view.header().request_id, request.header.request_id);
+    EXPECT_STREQ(request_view.header().service_name, kServiceName);
+    EXPECT_EQ(request_view.body().a, 20);
+    EXPECT_EQ(request_view.body().b, 22);
+
+    HakoCpp_AddTwoIntsResponse response_body{};
+    response_body.sum = request_view.body().a + request_view.body().b;
+    ASSERT_TRUE(service.reply(runtime.server(), request,
+        hakoniwa::pdu::rpc::HAKO_SERVICE_STATUS_DONE, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK, response_body));
+
+    std::string service_name;
+    RpcResponse response;
+    ASSERT_EQ(runtime.wait_client_event(service_name, response), ClientEventType::RESPONSE_IN);
+    decltype(service)::ResponseView response_view;
+    ASSERT_TRUE(service.get_response_view(response, response_view));
+    EXPECT_EQ(response_view.header().result_code, hakoniwa::pdu::rpc::HAKO_SERVICE_RESULT_CODE_OK);
+    EXPECT_EQ(response_view.body().sum, 42);
+}
+
+TEST(RpcWireSizeContractTest, PacketViewBoundsHeapArraysToThePacket)
+{
+    RpcRuntime runtime(kConfigPath);
+    ASSERT_TRUE(runtime.start());
+
+    HakoRpcServiceServerTemplateType(AddTwoInts) service;
+    HakoCpp_AddTwoIntsRequest request_body{};
+    hakoniwa::pdu::rpc::PduData pdu;
+    ASSERT_TRUE(service.set_request_body(runtime.client(), kServiceName, request_body, pdu));
+
+    // AddTwoInts has no arrays, so append a heap of four integers by hand.
+    HakoPduMetaDataType metadata{};
+    std::memcpy(&metadata, pdu.data(), sizeof(metadata));
+    const Hako_int32 values[] = {1, 2, 3, 4};
+    ASSERT_LE(static_cast<std::size_t>(metadata.total_size) + sizeof(values), pdu.size());
+    std::memcpy(pdu.data() + metadata.heap_off, values, sizeof(values));
+    metadata.total_size = metadata.heap_off + static_cast<Hako_int32>(sizeof(values));
+    std::memcpy(pdu.data(), &metadata, sizeof(metadata));
+    pdu.resize(static_cast<std::size_t>(metadata.total_size));
+
+    hakoniwa::pdu::rpc::RpcPacketView<Hako_AddTwoIntsRequestPacket> view;
+    ASSERT_TRUE(view.bind(pdu.data(), pdu.size()));
+    std::span<const Hako_int32> array;
+    ASSERT_TRUE(view.heap_array(4, 0, array));
+    EXPECT_EQ(std::vector<Hako_int32>(array.begin(), array.end()), (std::vector<Hako_int32>{1, 2, 3, 4}));
+    ASSERT_TRUE(view.heap_array(2, 8, array));
+    EXPECT_EQ(array[0], 3);
+    ASSERT_TRUE(view.heap_array(0, 16, array));
+    EXPECT_TRUE(array.empty());
+
+    EXPECT_FALSE(view.heap_array(5, 0, array));
+    EXPECT_FALSE(view.heap_array(1, 16, array));
+    EXPECT_FALSE(view.heap_array(1, 2, array));
+    EXPECT_FALSE(view.heap_array(-1, 0, array));
+    EXPECT_TRUE(array.empty());
+
+    EXPECT_FALSE(view.bind(pdu.data(), metadata.base_off + sizeof(Hako_ServiceRequestHeader) - 1));
+    EXPECT_FALSE(view.valid());
+}
+
+} // namespace
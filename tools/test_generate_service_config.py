@@ -151,6 +151,54 @@ class GenerateServiceConfigTest(unittest.TestCase):
         with self.assertRaisesRegex(GENERATOR.ConfigurationError, "unknown fields"):
             GENERATOR.resolve(unknown)
 
+    def test_cpp_header_lists_services_in_table_order(self) -> None:
+        source = manifest()
+        second = json.loads(json.dumps(source["services"][0]))
+        second["name"] = "Service/AddAgain"
+        second["clientNamePrefix"] = "hakoniwa_pdu_ros_add_again"
+        second["maxClients"] = 1
+        source["services"].append(second)
+        with tempfile.TemporaryDirectory() as temporary:
+            root = Path(temporary)
+            config = root / "service.json"
+            header = root / "include" / "service_table.hpp"
+            config.write_text(json.dumps(source), encoding="utf-8")
+
+            generated = GENERATOR.generate(
+                config, root / "generated", header, "app::services"
+            )
+            content = header.read_text(encoding="utf-8")
+
+        self.assertIn(header, generated)
+        self.assertIn("namespace app::services {", content)
+        self.assertEqual(
+            content.count(
+                '#include "hako_srv_msgs/pdu_cpptype_conv_AddTwoIntsRequestPacket.hpp"'
+            ),
+            1,
+        )
+        self.assertIn("static constexpr std::size_t ADD = 0;", content)
+        self.assertIn("static constexpr std::size_t ADD_AGAIN = 1;", content)
+        self.assertIn('{"hakoniwa_pdu_ros_add_1", 2, 3},', content)
+        self.assertIn(
+            '{"Service/Add", "hako_srv_msgs/AddTwoInts", 2, 296, 128, 288, 64, ADD_CLIENTS},',
+            content,
+        )
+        self.assertEqual(
+            content.count("HakoRpcServiceServerTemplateType(AddTwoInts)"), 2
+        )
+
+    def test_cpp_header_rejects_colliding_index_names(self) -> None:
+        source = manifest()
+        second = json.loads(json.dumps(source["services"][0]))
+        second["name"] = "Other/Add"
+        second["clientNamePrefix"] = "hakoniwa_pdu_ros_other_add"
+        source["services"].append(second)
+        with self.assertRaisesRegex(GENERATOR.ConfigurationError, "C\\+\\+ index name"):
+            GENERATOR.render_cpp_header(GENERATOR.resolve(source), "app")
+        with self.assertRaisesRegex(GENERATOR.ConfigurationError, "namespace"):
+            GENERATOR.render_cpp_header(GENERATOR.resolve(manifest()), "app::")
+
     def test_generation_is_idempotent(self) -> None:
         with tempfile.TemporaryDirectory() as temporary:
             root = Path(temporary)